@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "geometry.h"
+
+// Closest pair of points, divide and conquer (Shamos): the points sorted by x
+// are split in halves, the answer is the best of the halves or a pair across
+// the middle line. Such a pair lies in the strip |x - middle| < d, d - the best
+// distance of the halves; the strip is sorted by y (the halves come back sorted
+// by y, they are merged as in merge sort) and every point is compared with the
+// next ones while their y differ by less than d. O(n log n). Parts of at most
+// LEAF_SIZE points are sorted by y and scanned the same way.
+//
+// The halves of the upper log2(threads) levels are solved in parallel
+// (std::async), the first sorting is std::sort(std::execution::par).
+// Distances are exact squared int64_t.
+
+struct ClosestPairResult {
+    size_t first = 0;
+    size_t second = 0;
+    int64_t squared_distance = INT64_MAX;
+};
+
+namespace ClosestPairDetail {
+
+    // fewer points are solved in the same thread
+    constexpr size_t PARALLEL_THRESHOLD = 1 << 15;
+    constexpr size_t LEAF_SIZE = 16;
+
+    struct IndexedPoint {
+        Point point;
+        uint32_t index;
+    };
+
+    inline void Update(const IndexedPoint& a, const IndexedPoint& b, ClosestPairResult& best) {
+        const int64_t squared_distance = SquaredDistance(a.point, b.point);
+        if (squared_distance < best.squared_distance) {
+            best = {a.index, b.index, squared_distance};
+        }
+    }
+
+    inline bool ByY(const IndexedPoint& lhs, const IndexedPoint& rhs) {
+        return lhs.point.y < rhs.point.y;
+    }
+
+    // compares every point with the next ones while dy^2 < best, points sorted by y
+    inline void ScanByY(const IndexedPoint* points, size_t count, ClosestPairResult& best) {
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = i + 1; j < count; ++j) {
+                const int64_t dy = static_cast<int64_t>(points[j].point.y) - points[i].point.y;
+                if (dy * dy >= best.squared_distance) {
+                    break;
+                }
+                Update(points[i], points[j], best);
+            }
+        }
+    }
+
+    // points sorted by x, returns them sorted by y; buffer - count free elements
+    inline ClosestPairResult Solve(IndexedPoint* points, size_t count, IndexedPoint* buffer, int parallel_depth) {
+        ClosestPairResult best;
+        if (count <= LEAF_SIZE) {
+            std::sort(points, points + count, ByY);
+            ScanByY(points, count, best);
+            return best;
+        }
+        const size_t middle = count / 2;
+        const int64_t middle_x = points[middle].point.x;
+        ClosestPairResult right;
+        if (parallel_depth > 0 && count >= PARALLEL_THRESHOLD) {
+            auto left = std::async(std::launch::async, Solve, points, middle, buffer, parallel_depth - 1);
+            right = Solve(points + middle, count - middle, buffer + middle, parallel_depth - 1);
+            best = left.get();
+        } else {
+            best = Solve(points, middle, buffer, 0);
+            right = Solve(points + middle, count - middle, buffer + middle, 0);
+        }
+        if (right.squared_distance < best.squared_distance) {
+            best = right;
+        }
+
+        // merged into the buffer, copied back; the strip goes to the beginning
+        // of the buffer in the same pass, it never overtakes the reading
+        std::merge(points, points + middle, points + middle, points + count, buffer, ByY);
+        size_t strip_size = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const IndexedPoint p = buffer[i];
+            points[i] = p;
+            const int64_t dx = p.point.x - middle_x;
+            if (dx * dx < best.squared_distance) {
+                buffer[strip_size++] = p;
+            }
+        }
+        ScanByY(buffer, strip_size, best);
+        return best;
+    }
+
+}
+
+// at least 2 points; first < second are indices in points
+inline ClosestPairResult ClosestPair(const std::vector<Point>& points) {
+    using namespace ClosestPairDetail;
+    std::vector<IndexedPoint> sorted(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        sorted[i] = {points[i], static_cast<uint32_t>(i)};
+    }
+    std::sort(std::execution::par, sorted.begin(), sorted.end(), [](const IndexedPoint& lhs, const IndexedPoint& rhs) {
+        return lhs.point.x < rhs.point.x;
+    });
+    std::vector<IndexedPoint> buffer(points.size());
+    int parallel_depth = 0;
+    while ((1u << parallel_depth) < std::thread::hardware_concurrency()) {
+        ++parallel_depth;
+    }
+    ClosestPairResult best = Solve(sorted.data(), sorted.size(), buffer.data(), parallel_depth);
+    if (best.first > best.second) {
+        std::swap(best.first, best.second);
+    }
+    return best;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <vector>
+#include "geometry.h"
+#include "point_batch.h"
+#include "workload.h"
+
+// Convex hull: the vertices counter-clockwise from the smallest point by (x, y),
+// without points in the middle of the edges.
+//
+// AndrewConvexHull - Andrew's monotone chain: sort by (x, y), the lower chain
+// goes left to right and drops its last point while it doesn't turn left,
+// the upper chain - the same with right turns. O(n log n), exact predicates.
+//
+// ConvexHull - the same in parallel:
+// 1. Akl-Toussaint: the extreme points in 8 directions (min x, min x + y, ...)
+//    are hull vertices, the points strictly inside their octagon are not,
+//    they are thrown away by StrictlyInside (SIMD) in all threads. For random
+//    points almost nothing is left.
+// 2. The rest is sorted by std::sort(std::execution::par).
+// 3. The sorted points are split into blocks, the chains of every block are
+//    built in parallel: a point that is not on the chain of its block is not
+//    on the chain of all points. The block chains are again sorted by x, the
+//    final chains are built over their concatenation.
+
+namespace ConvexHullDetail {
+
+    // fewer points are not worth the threads
+    constexpr size_t PARALLEL_THRESHOLD = 1 << 14;
+
+    // counter-clockwise, starting from (-1, 0)
+    constexpr int DIRECTIONS[8][2] = {{-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}};
+
+    // the lower (turn = 1) or the upper (turn = -1) chain of the points sorted by (x, y)
+    template<typename It>
+    std::vector<Point> Chain(It first, It last, int turn) {
+        std::vector<Point> chain;
+        for (; first != last; ++first) {
+            while (chain.size() >= 2 && turn * Orientation(chain[chain.size() - 2], chain.back(), *first) <= 0) {
+                chain.pop_back();
+            }
+            chain.push_back(*first);
+        }
+        return chain;
+    }
+
+    // the lower chain and the reversed upper one without their common ends
+    inline std::vector<Point> JoinChains(const std::vector<Point>& lower, const std::vector<Point>& upper) {
+        std::vector<Point> hull = lower;
+        if (upper.size() > 2) {
+            hull.insert(hull.end(), upper.rbegin() + 1, upper.rend() - 1);
+        }
+        return hull;
+    }
+
+    // the points with the largest scalar product with every direction
+    // (the smallest by (x, y) of equal ones), without repeats
+    inline std::vector<Point> ExtremePolygon(const PointBatch& points) {
+        auto better = [](int k, Point lhs, Point rhs) {
+            const int64_t lhs_product = static_cast<int64_t>(DIRECTIONS[k][0]) * lhs.x + static_cast<int64_t>(DIRECTIONS[k][1]) * lhs.y;
+            const int64_t rhs_product = static_cast<int64_t>(DIRECTIONS[k][0]) * rhs.x + static_cast<int64_t>(DIRECTIONS[k][1]) * rhs.y;
+            return lhs_product > rhs_product || (lhs_product == rhs_product && lhs < rhs);
+        };
+        const size_t block_count = ParallelBlockCount(points.size());
+        std::vector<std::vector<Point>> block_extremes(block_count, std::vector<Point>(8, points[0]));
+        ParallelFor(points.size(), [&](size_t block, size_t begin, size_t end) {
+            std::vector<Point>& extremes = block_extremes[block];
+            for (size_t i = begin; i < end; ++i) {
+                const Point p = points[i];
+                for (int k = 0; k < 8; ++k) {
+                    if (better(k, p, extremes[k])) {
+                        extremes[k] = p;
+                    }
+                }
+            }
+        });
+        std::vector<Point> polygon;
+        for (int k = 0; k < 8; ++k) {
+            Point extreme = block_extremes[0][k];
+            for (const auto& extremes : block_extremes) {
+                if (better(k, extremes[k], extreme)) {
+                    extreme = extremes[k];
+                }
+            }
+            if (polygon.empty() || polygon.back() != extreme) {
+                polygon.push_back(extreme);
+            }
+        }
+        while (polygon.size() > 1 && polygon.back() == polygon.front()) {
+            polygon.pop_back();
+        }
+        return polygon;
+    }
+
+    // the points that are not strictly inside the extreme polygon
+    inline std::vector<Point> FilterInterior(const std::vector<Point>& input) {
+        PointBatch points;
+        points.x.resize(input.size());
+        points.y.resize(input.size());
+        ParallelFor(input.size(), [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                points.x[i] = input[i].x;
+                points.y[i] = input[i].y;
+            }
+        });
+        const std::vector<Point> polygon = ExtremePolygon(points);
+        if (polygon.size() < 3) {
+            return input;
+        }
+        constexpr size_t CHUNK = 1024;
+        std::vector<std::vector<Point>> block_rest(ParallelBlockCount(input.size()));
+        ParallelFor(input.size(), [&](size_t block, size_t begin, size_t end) {
+            uint8_t inside[CHUNK];
+            for (size_t first = begin; first < end; first += CHUNK) {
+                const size_t last = std::min(end, first + CHUNK);
+                StrictlyInside(polygon, points, first, last, inside);
+                for (size_t i = first; i < last; ++i) {
+                    if (!inside[i - first]) {
+                        block_rest[block].push_back(input[i]);
+                    }
+                }
+            }
+        });
+        std::vector<Point> rest;
+        for (const auto& block : block_rest) {
+            rest.insert(rest.end(), block.begin(), block.end());
+        }
+        return rest;
+    }
+
+}
+
+inline std::vector<Point> AndrewConvexHull(std::vector<Point> points) {
+    using namespace ConvexHullDetail;
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    return JoinChains(Chain(points.begin(), points.end(), 1), Chain(points.begin(), points.end(), -1));
+}
+
+inline std::vector<Point> ConvexHull(const std::vector<Point>& input) {
+    using namespace ConvexHullDetail;
+    if (input.size() < PARALLEL_THRESHOLD) {
+        return AndrewConvexHull(input);
+    }
+    std::vector<Point> points = FilterInterior(input);
+    std::sort(std::execution::par, points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    const size_t block_count = ParallelBlockCount(points.size());
+    std::vector<std::vector<Point>> block_lower(block_count);
+    std::vector<std::vector<Point>> block_upper(block_count);
+    ParallelFor(points.size(), [&](size_t block, size_t begin, size_t end) {
+        block_lower[block] = Chain(points.begin() + begin, points.begin() + end, 1);
+        block_upper[block] = Chain(points.begin() + begin, points.begin() + end, -1);
+    });
+    std::vector<Point> lower_candidates;
+    std::vector<Point> upper_candidates;
+    for (size_t block = 0; block < block_count; ++block) {
+        lower_candidates.insert(lower_candidates.end(), block_lower[block].begin(), block_lower[block].end());
+        upper_candidates.insert(upper_candidates.end(), block_upper[block].begin(), block_upper[block].end());
+    }
+    return JoinChains(Chain(lower_candidates.begin(), lower_candidates.end(), 1),
+                      Chain(upper_candidates.begin(), upper_candidates.end(), -1));
+}
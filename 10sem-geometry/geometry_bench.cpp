@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "closest_pair.h"
+#include "convex_hull.h"
+#include "geometry.h"
+#include "point_batch.h"
+#include "profile.h"
+#include "workload.h"
+
+using namespace std;
+
+// The geometry kernel against the simple ways on random points (Philox, the
+// i-th point depends only on (seed, i)):
+// - predicates: a loop of Orientation / InCircle against the batched versions
+//   over a PointBatch, and InCircles on lattice points of one circle, where
+//   the filter never decides and everything goes to __int128;
+// - convex hull: gift wrapping (O(n h), O(n^2) in the worst case) and the
+//   sequential AndrewConvexHull against the parallel ConvexHull, points in a
+//   square (the hull is O(log n) points) and in a disk (O(n^(1/3)));
+// - closest pair: all pairs (O(n^2)) on the small input, then ClosestPair alone.
+// usage: ./geometry_bench [points] [small points]   (10^7 and 2 * 10^4 by default)
+
+vector<Point> GeneratePoints(uint64_t seed, size_t count, bool disk) {
+    vector<Point> points(count);
+    ParallelFor(count, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            PhiloxRng rng(seed, i);
+            while (true) {
+                const Point p = {rng.UniformInt(-MAX_COORDINATE, MAX_COORDINATE), rng.UniformInt(-MAX_COORDINATE, MAX_COORDINATE)};
+                if (!disk || static_cast<double>(p.x) * p.x + static_cast<double>(p.y) * p.y <= static_cast<double>(MAX_COORDINATE) * MAX_COORDINATE) {
+                    points[i] = p;
+                    break;
+                }
+            }
+        }
+    });
+    return points;
+}
+
+// all lattice points of the circle x^2 + y^2 = radius^2 (radius = 5^k has many)
+vector<Point> CirclePoints(int64_t radius) {
+    vector<Point> points;
+    for (int64_t x = -radius; x <= radius; ++x) {
+        const int64_t rest = radius * radius - x * x;
+        const int64_t y = llround(sqrt(static_cast<double>(rest)));
+        if (y * y == rest) {
+            points.push_back({static_cast<int32_t>(x), static_cast<int32_t>(y)});
+            if (y != 0) {
+                points.push_back({static_cast<int32_t>(x), static_cast<int32_t>(-y)});
+            }
+        }
+    }
+    return points;
+}
+
+vector<Point> GiftWrappingHull(const vector<Point>& points) {
+    const Point start = *min_element(points.begin(), points.end());
+    vector<Point> hull;
+    Point current = start;
+    do {
+        hull.push_back(current);
+        Point next = current;
+        for (const Point p : points) {
+            if (p == current) {
+                continue;
+            }
+            const int orientation = next == current ? -1 : Orientation(current, next, p);
+            if (orientation < 0 || (orientation == 0 && SquaredDistance(current, p) > SquaredDistance(current, next))) {
+                next = p;
+            }
+        }
+        current = next;
+    } while (current != start);
+    return hull;
+}
+
+ClosestPairResult NaiveClosestPair(const vector<Point>& points) {
+    ClosestPairResult best;
+    for (size_t i = 0; i < points.size(); ++i) {
+        for (size_t j = i + 1; j < points.size(); ++j) {
+            const int64_t squared_distance = SquaredDistance(points[i], points[j]);
+            if (squared_distance < best.squared_distance) {
+                best = {i, j, squared_distance};
+            }
+        }
+    }
+    return best;
+}
+
+void BenchPredicates(const vector<Point>& points) {
+    const PointBatch batch(points);
+    const Point a = {-MAX_COORDINATE / 2, -MAX_COORDINATE / 3};
+    const Point b = {MAX_COORDINATE / 2, -MAX_COORDINATE / 4};
+    const Point c = {MAX_COORDINATE / 5, MAX_COORDINATE / 2};
+    cerr << "predicates: " << points.size() << " points" << endl;
+    vector<int8_t> expected(points.size());
+    vector<int8_t> signs(points.size());
+    {
+        LOG_DURATION("  Orientation loop");
+        for (size_t i = 0; i < points.size(); ++i) {
+            expected[i] = Orientation(a, b, points[i]);
+        }
+    }
+    {
+        LOG_DURATION("  Orientations");
+        Orientations(a, b, batch, 0, batch.size(), signs.data());
+    }
+    if (signs != expected) {
+        cout << "WRONG RESULT" << endl;
+    }
+    {
+        LOG_DURATION("  InCircle loop");
+        for (size_t i = 0; i < points.size(); ++i) {
+            expected[i] = InCircle(a, b, c, points[i]);
+        }
+    }
+    {
+        LOG_DURATION("  InCircles");
+        InCircles(a, b, c, batch, 0, batch.size(), signs.data());
+    }
+    if (signs != expected) {
+        cout << "WRONG RESULT" << endl;
+    }
+
+    // x^2 + y^2 = 5^20 (5^10 < 2^29) has 4 * 21 = 84 lattice points
+    const vector<Point> circle = CirclePoints(9'765'625);
+    const PointBatch circle_batch(circle);
+    vector<int8_t> circle_signs(circle.size());
+    size_t nonzero = 0;
+    for (size_t i = 0; i + 2 < circle.size(); ++i) {
+        InCircles(circle[i], circle[i + 1], circle[i + 2], circle_batch, 0, circle_batch.size(), circle_signs.data());
+        nonzero += circle.size() - count(circle_signs.begin(), circle_signs.end(), 0);
+    }
+    cerr << "  cocircular: " << circle.size() << " points on x^2 + y^2 = 5^20, nonzero InCircle " << nonzero << endl;
+    if (nonzero != 0) {
+        cout << "WRONG RESULT" << endl;
+    }
+}
+
+void BenchHull(const string& title, const vector<Point>& points, bool with_baseline) {
+    cerr << title << ": " << points.size() << " points" << endl;
+    vector<Point> hull;
+    {
+        LOG_DURATION("  ConvexHull");
+        hull = ConvexHull(points);
+    }
+    vector<Point> andrew;
+    {
+        LOG_DURATION("  AndrewConvexHull");
+        andrew = AndrewConvexHull(points);
+    }
+    if (andrew != hull) {
+        cout << "WRONG RESULT" << endl;
+    }
+    if (with_baseline) {
+        vector<Point> wrapped;
+        {
+            LOG_DURATION("  GiftWrappingHull");
+            wrapped = GiftWrappingHull(points);
+        }
+        if (wrapped != hull) {
+            cout << "WRONG RESULT" << endl;
+        }
+    }
+    cerr << "  hull " << hull.size() << " points" << endl;
+}
+
+void BenchClosestPair(const vector<Point>& points, bool with_baseline) {
+    cerr << "closest pair: " << points.size() << " points" << endl;
+    ClosestPairResult result;
+    {
+        LOG_DURATION("  ClosestPair");
+        result = ClosestPair(points);
+    }
+    if (SquaredDistance(points[result.first], points[result.second]) != result.squared_distance) {
+        cout << "WRONG RESULT" << endl;
+    }
+    if (with_baseline) {
+        ClosestPairResult naive;
+        {
+            LOG_DURATION("  NaiveClosestPair");
+            naive = NaiveClosestPair(points);
+        }
+        if (naive.squared_distance != result.squared_distance) {
+            cout << "WRONG RESULT" << endl;
+        }
+    }
+    cerr << "  distance " << sqrt(static_cast<double>(result.squared_distance)) << endl;
+}
+
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? stoul(argv[1]) : 10'000'000;
+    const size_t small_count = argc > 2 ? stoul(argv[2]) : 20'000;
+
+    BenchPredicates(GeneratePoints(1, count, false));
+    cerr << endl;
+    for (const bool disk : {false, true}) {
+        const string title = disk ? "disk" : "square";
+        BenchHull(title, GeneratePoints(2, small_count, disk), true);
+        BenchHull(title, GeneratePoints(3, count, disk), false);
+    }
+    cerr << endl;
+    BenchClosestPair(GeneratePoints(4, small_count, false), true);
+    BenchClosestPair(GeneratePoints(5, count, false), false);
+}
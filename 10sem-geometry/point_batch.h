@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "geometry.h"
+
+#ifdef __AVX2__
+  #include <immintrin.h>
+#endif
+
+// Points in the SoA layout (all x, then all y) and predicates for many points
+// against the same line or circle.
+//
+// Orientations: the sign of (b - a) x (p - a) for every p. The differences fit
+// in int32, so 8 points are taken at once: _mm256_mul_epi32 multiplies the even
+// 32-bit lanes into 64-bit products, the odd lanes are shifted down to the
+// even ones for the second multiplication. Exact, no filter.
+//
+// InCircles: InCircle(a, b, c, p) for every p, 4 points at once in double
+// lanes with the error bound of geometry.h; lanes whose sign isn't certain are
+// recomputed by the exact InCircle.
+//
+// StrictlyInside: whether p is strictly inside a convex polygon, that is
+// strictly to the left of all its edges - 8 points against every edge, used by
+// ConvexHull to throw away most of the points before sorting.
+//
+// Without AVX2 (no -mavx2 / -march=native) all of them are plain loops.
+
+struct PointBatch {
+    std::vector<int32_t> x;
+    std::vector<int32_t> y;
+
+    PointBatch() = default;
+
+    explicit PointBatch(const std::vector<Point>& points)
+        : x(points.size())
+        , y(points.size())
+    {
+        for (size_t i = 0; i < points.size(); ++i) {
+            x[i] = points[i].x;
+            y[i] = points[i].y;
+        }
+    }
+
+    size_t size() const {
+        return x.size();
+    }
+
+    Point operator[](size_t i) const {
+        return {x[i], y[i]};
+    }
+};
+
+namespace PointBatchDetail {
+
+#ifdef __AVX2__
+    // 4 bits into the even bits of 8
+    constexpr uint8_t SPREAD[16] = {0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15,
+                                    0x40, 0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55};
+
+    // (u_x * dy - u_y * dx) > 0 and < 0 for 8 points, as 8-bit masks
+    inline void CrossSigns(__m256i ux, __m256i uy, __m256i dx, __m256i dy, int& positive, int& negative) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i even = _mm256_sub_epi64(_mm256_mul_epi32(ux, dy), _mm256_mul_epi32(uy, dx));
+        const __m256i odd = _mm256_sub_epi64(
+            _mm256_mul_epi32(_mm256_srli_epi64(ux, 32), _mm256_srli_epi64(dy, 32)),
+            _mm256_mul_epi32(_mm256_srli_epi64(uy, 32), _mm256_srli_epi64(dx, 32)));
+        // the 4 bits of the 64-bit lanes: even points, then odd ones
+        const int even_positive = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(even, zero)));
+        const int odd_positive = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(odd, zero)));
+        const int even_negative = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(zero, even)));
+        const int odd_negative = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(zero, odd)));
+        positive = SPREAD[even_positive] | SPREAD[odd_positive] << 1;
+        negative = SPREAD[even_negative] | SPREAD[odd_negative] << 1;
+    }
+
+    inline __m256i Load(const int32_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+#endif
+
+}
+
+// signs[i - first] = Orientation(a, b, points[i]) for i in [first, last)
+inline void Orientations(Point a, Point b, const PointBatch& points, size_t first, size_t last, int8_t* signs) {
+    size_t i = first;
+#ifdef __AVX2__
+    using namespace PointBatchDetail;
+    const __m256i ux = _mm256_set1_epi32(b.x - a.x);
+    const __m256i uy = _mm256_set1_epi32(b.y - a.y);
+    const __m256i ax = _mm256_set1_epi32(a.x);
+    const __m256i ay = _mm256_set1_epi32(a.y);
+    for (; i + 8 <= last; i += 8) {
+        int positive;
+        int negative;
+        CrossSigns(ux, uy, _mm256_sub_epi32(Load(&points.x[i]), ax), _mm256_sub_epi32(Load(&points.y[i]), ay),
+                   positive, negative);
+        for (int k = 0; k < 8; ++k) {
+            signs[i - first + k] = (positive >> k & 1) - (negative >> k & 1);
+        }
+    }
+#endif
+    for (; i < last; ++i) {
+        signs[i - first] = Orientation(a, b, points[i]);
+    }
+}
+
+// signs[i - first] = InCircle(a, b, c, points[i]) for i in [first, last)
+inline void InCircles(Point a, Point b, Point c, const PointBatch& points, size_t first, size_t last, int8_t* signs) {
+    size_t i = first;
+#ifdef __AVX2__
+    const __m256d bound_factor = _mm256_set1_pd(GeometryDetail::IN_CIRCLE_BOUND);
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(INT64_MAX));
+    const __m256d ax = _mm256_set1_pd(a.x);
+    const __m256d ay = _mm256_set1_pd(a.y);
+    const __m256d bx = _mm256_set1_pd(b.x);
+    const __m256d by = _mm256_set1_pd(b.y);
+    const __m256d cx = _mm256_set1_pd(c.x);
+    const __m256d cy = _mm256_set1_pd(c.y);
+    auto absolute = [&](__m256d v) { return _mm256_and_pd(v, abs_mask); };
+    for (; i + 4 <= last; i += 4) {
+        const __m256d dx = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&points.x[i])));
+        const __m256d dy = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&points.y[i])));
+        const __m256d adx = _mm256_sub_pd(ax, dx);
+        const __m256d ady = _mm256_sub_pd(ay, dy);
+        const __m256d bdx = _mm256_sub_pd(bx, dx);
+        const __m256d bdy = _mm256_sub_pd(by, dy);
+        const __m256d cdx = _mm256_sub_pd(cx, dx);
+        const __m256d cdy = _mm256_sub_pd(cy, dy);
+        const __m256d alift = _mm256_add_pd(_mm256_mul_pd(adx, adx), _mm256_mul_pd(ady, ady));
+        const __m256d blift = _mm256_add_pd(_mm256_mul_pd(bdx, bdx), _mm256_mul_pd(bdy, bdy));
+        const __m256d clift = _mm256_add_pd(_mm256_mul_pd(cdx, cdx), _mm256_mul_pd(cdy, cdy));
+        const __m256d bdxcdy = _mm256_mul_pd(bdx, cdy);
+        const __m256d cdxbdy = _mm256_mul_pd(cdx, bdy);
+        const __m256d cdxady = _mm256_mul_pd(cdx, ady);
+        const __m256d adxcdy = _mm256_mul_pd(adx, cdy);
+        const __m256d adxbdy = _mm256_mul_pd(adx, bdy);
+        const __m256d bdxady = _mm256_mul_pd(bdx, ady);
+        const __m256d det = _mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(alift, _mm256_sub_pd(bdxcdy, cdxbdy)),
+                          _mm256_mul_pd(blift, _mm256_sub_pd(cdxady, adxcdy))),
+            _mm256_mul_pd(clift, _mm256_sub_pd(adxbdy, bdxady)));
+        const __m256d permanent = _mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(alift, _mm256_add_pd(absolute(bdxcdy), absolute(cdxbdy))),
+                          _mm256_mul_pd(blift, _mm256_add_pd(absolute(cdxady), absolute(adxcdy)))),
+            _mm256_mul_pd(clift, _mm256_add_pd(absolute(adxbdy), absolute(bdxady))));
+        const __m256d bound = _mm256_mul_pd(bound_factor, permanent);
+        const int positive = _mm256_movemask_pd(_mm256_cmp_pd(det, bound, _CMP_GT_OQ));
+        const int negative = _mm256_movemask_pd(_mm256_cmp_pd(det, _mm256_sub_pd(_mm256_setzero_pd(), bound), _CMP_LT_OQ));
+        for (int k = 0; k < 4; ++k) {
+            if ((positive | negative) >> k & 1) {
+                signs[i - first + k] = (positive >> k & 1) - (negative >> k & 1);
+            } else {
+                signs[i - first + k] = InCircle(a, b, c, points[i + k]);
+            }
+        }
+    }
+#endif
+    for (; i < last; ++i) {
+        signs[i - first] = InCircle(a, b, c, points[i]);
+    }
+}
+
+// inside[i - first] = points[i] is strictly inside the convex polygon
+// (counter-clockwise, at least 3 vertices) for i in [first, last)
+inline void StrictlyInside(const std::vector<Point>& polygon, const PointBatch& points, size_t first, size_t last, uint8_t* inside) {
+    size_t i = first;
+#ifdef __AVX2__
+    using namespace PointBatchDetail;
+    for (; i + 8 <= last; i += 8) {
+        const __m256i x = Load(&points.x[i]);
+        const __m256i y = Load(&points.y[i]);
+        int mask = 0xFF;
+        for (size_t k = 0; k < polygon.size() && mask != 0; ++k) {
+            const Point a = polygon[k];
+            const Point b = polygon[k + 1 == polygon.size() ? 0 : k + 1];
+            int positive;
+            int negative;
+            CrossSigns(_mm256_set1_epi32(b.x - a.x), _mm256_set1_epi32(b.y - a.y),
+                       _mm256_sub_epi32(x, _mm256_set1_epi32(a.x)), _mm256_sub_epi32(y, _mm256_set1_epi32(a.y)),
+                       positive, negative);
+            mask &= positive;
+        }
+        for (int k = 0; k < 8; ++k) {
+            inside[i - first + k] = mask >> k & 1;
+        }
+    }
+#endif
+    for (; i < last; ++i) {
+        bool strictly = true;
+        for (size_t k = 0; k < polygon.size() && strictly; ++k) {
+            strictly = Orientation(polygon[k], polygon[k + 1 == polygon.size() ? 0 : k + 1], points[i]) > 0;
+        }
+        inside[i - first] = strictly;
+    }
+}
@@ -1,29 +1,105 @@
-#include <iostream>
-#include <set>
-#include <tuple>
-
-// long long
-// same pairs
-int main() {
-    long long N, A;
-    std::cin >> N >> A;
-    std::set<std::tuple<long long, long long, long long>> tasks;
-
-    long long ai, bi;
-    for (long long i = 0; i != N; ++i) {
-        std::cin >> ai >> bi;
-        tasks.emplace(ai, bi, i);
-    }
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "fast_io.h"
+
+// ai, bi <= 10^9 < 2^32, so a task is packed to one uint64_t: a << 32 | b.
+// Sorting of the packed numbers sorts by a, one 8-byte element per task
+// instead of a std::set node with a tuple.
+// Answer may need long long: A grows up to 10^9 + N * 10^9.
+//
+// usage: ./1_tasks            all tasks are read, then sorted (in parallel, link with -ltbb)
+//        ./1_tasks --online   tasks are taken one by one as they come, see OnlineScheduler
+
+uint64_t Pack(long long a, long long b) {
+    return static_cast<uint64_t>(a) << 32 | static_cast<uint64_t>(b);
+}
+
+long long TaskSkill(uint64_t task) {
+    return task >> 32;
+}
+
+long long TaskBonus(uint64_t task) {
+    return task & UINT32_MAX;
+}
+
+long long MaxTasks(std::vector<uint64_t>& tasks, long long A) {
+    std::sort(std::execution::par, tasks.begin(), tasks.end());
 
     long long max_tasks = 0;
-    for (const auto& task : tasks) {
-        if (std::get<0>(task) <= A) {
-            A += std::get<1>(task);
-            ++max_tasks;
-        } else {
+    for (const uint64_t task : tasks) {
+        if (TaskSkill(task) > A) {
             break;
         }
+        A += TaskBonus(task);
+        ++max_tasks;
+    }
+    return max_tasks;
+}
+
+// Tasks come one at a time. A task that can be solved now is solved at once
+// (solving never hurts: the skill only grows), the others wait in a min-heap
+// by a and are released when the skill reaches them.
+// After every Add, Solved() is the answer for the tasks seen so far.
+class OnlineScheduler {
+public:
+    explicit OnlineScheduler(long long skill)
+        : skill_(skill)
+    {
     }
 
-    std::cout << max_tasks << std::endl;
+    void Add(long long a, long long b) {
+        if (a > skill_) {
+            waiting_.push(Pack(a, b));
+            return;
+        }
+        skill_ += b;
+        ++solved_;
+        while (!waiting_.empty() && TaskSkill(waiting_.top()) <= skill_) {
+            skill_ += TaskBonus(waiting_.top());
+            ++solved_;
+            waiting_.pop();
+        }
+    }
+
+    long long Solved() const {
+        return solved_;
+    }
+
+    long long Skill() const {
+        return skill_;
+    }
+
+private:
+    long long skill_;
+    long long solved_ = 0;
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<>> waiting_;
+};
+
+int main(int argc, char* argv[]) {
+    FastReader in;
+    FastWriter out;
+    const long long N = in.read_int<long long>();
+    const long long A = in.read_int<long long>();
+
+    if (argc > 1 && std::strcmp(argv[1], "--online") == 0) {
+        OnlineScheduler scheduler(A);
+        for (long long i = 0; i != N; ++i) {
+            const long long ai = in.read_int<long long>();
+            scheduler.Add(ai, in.read_int<long long>());
+        }
+        out.write_int(scheduler.Solved());
+    } else {
+        std::vector<uint64_t> tasks(N);
+        for (uint64_t& task : tasks) {
+            const long long ai = in.read_int<long long>();
+            task = Pack(ai, in.read_int<long long>());
+        }
+        out.write_int(MaxTasks(tasks, A));
+    }
+    out.write_char('\n');
 }
@@ -1,59 +1,66 @@
-#include <iostream>
-#include <set>
+#include <algorithm>
+#include <functional>
 #include <vector>
+#include "fast_io.h"
 
-struct Color {
-    int max_value;
-    int color;
+// Colors are numbered in the order of creation. A new color is created only
+// when the maxima of all colors are >= num, so its maximum is the smallest:
+// maxima of colors 1, 2, ..., m are non-increasing. The color for num is the first
+// one with maximum < num (binary search), after the update its maximum is num,
+// and the previous color's maximum is still >= num: the array stays sorted.
+// This is patience sorting: a flat array instead of std::set, no node allocations
+// and rebalancing, only O(colors) memory.
+//
+// The number of colors is printed before the colors, so they are known only
+// after the whole input. If the input is a file, it's read twice and the colors
+// are printed on the second pass without storing them; from a pipe they are stored.
 
-    Color (int max_value, int color): max_value(max_value), color(color) {}
-};
+int AssignColor(std::vector<int>& maxima, int num) {
+    const auto color = std::upper_bound(maxima.begin(), maxima.end(), num, std::greater<>());
+    if (color == maxima.end()) {
+        maxima.push_back(num);
+        return maxima.size();
+    }
+    *color = num;
+    return color - maxima.begin() + 1;
+}
 
 int main() {
-    // want to use upper_bound. 2 > 3 in this function
-    auto max_to_min_cmp = [](const Color& a, const Color& b) {
-        return a.max_value > b.max_value || (a.max_value == b.max_value && a.color > b.color);
-    };
-    std::set<Color, decltype(max_to_min_cmp)> max_to_color(max_to_min_cmp);
-
-    int n;
-    std::cin >> n;
+    FastReader in;
+    FastWriter out;
 
-    std::vector<int> order(n);
-
-    int max_color = 0;
-    int num;
-    // will use this pair for searching in max_to_color set
-    auto to_search = Color{-1, -1};
+    const int n = in.read_int();
+    std::vector<int> maxima;
+    std::vector<int> order;
+    const bool two_passes = in.rewind();
+    if (two_passes) {
+        in.read_int();
+    } else {
+        order.reserve(n);
+    }
 
     for (int i = 0; i != n; ++i) {
-        std::cin >> num;
-
-        to_search.max_value = num;
-
-        auto upper = max_to_color.upper_bound(to_search);
-        // if we found the color with largest value lower then num.
-        if (upper != max_to_color.end()) {
-            order[i] = upper->color;
-
-            auto new_max = Color{num, upper->color};
-            max_to_color.erase(upper);
-            max_to_color.insert(new_max);
-        } else {
-            // create new color
-            max_to_color.emplace(num, ++max_color);
-            order[i] = max_color;
+        const int color = AssignColor(maxima, in.read_int<long long>());
+        if (!two_passes) {
+            order.push_back(color);
         }
     }
 
-    std::cout << max_to_color.size() << std::endl;
+    out.write_int(maxima.size());
+    out.write_char('\n');
 
-    for (int i = 0; i != order.size(); ++i) {
-        std::cout << order[i];
-        if (i != order.size() - 1) {
-            std::cout << " ";
-        } else {
-            std::cout << std::endl;
+    if (two_passes) {
+        in.rewind();
+        in.read_int();
+        maxima.clear();
+        for (int i = 0; i != n; ++i) {
+            out.write_int(AssignColor(maxima, in.read_int<long long>()));
+            out.write_char(i != n - 1 ? ' ' : '\n');
+        }
+    } else {
+        for (int i = 0; i != n; ++i) {
+            out.write_int(order[i]);
+            out.write_char(i != n - 1 ? ' ' : '\n');
         }
     }
 }
@@ -37,69 +37,312 @@
 #include <iomanip>
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <future>
+#include <numeric>
+#include <random>
+#include <thread>
 
-struct plate {
-    double a, b;
-    int idx;
+#ifdef __AVX2__
+  #include <immintrin.h>
+#endif
+
+// Plates in structure-of-arrays layout: a[k], b[k] - times of plate k.
+// The dissolve time of an order is computed without changing the plates:
+// only the two plates being dissolved right now (the left one by A and the right
+// one by B) are partially dissolved, their rest is kept in local variables.
+// So many orders can be scored on the same plates, 4 at once in AVX lanes and
+// in several threads (DissolveTimes).
+//
+// ./3_peregorodki --verify additionally checks the greedy order (to stderr):
+// the other comparator, all swaps of two plates (local search) and, for N <= 8,
+// all permutations.
 
-    plate(double a, double b, int idx): a(a), b(b), idx(idx){}
+struct Plates {
+    std::vector<double> a, b;
+
+    int size() const {
+        return a.size();
+    }
 };
 
-double run(std::vector<plate>& v) {
-    int i = 0, j = v.size() - 1;
+double DissolveTime(const Plates& plates, const int* order) {
+    int i = 0, j = plates.size() - 1;
+    // left plate order[i] is dissolved by A, right plate order[j] by B
+    double la = plates.a[order[i]], lb = plates.b[order[i]];
+    double ra = plates.a[order[j]], rb = plates.b[order[j]];
     double dissolve_time = 0;
     while (i < j) {
         // left dissolved earlier
-        if (v[i].a < v[j].b) {
-            v[j].a = v[j].a * (v[j].b - v[i].a) / v[j].b;
-            v[j].b = v[j].b - v[i].a;
-            dissolve_time += v[i].a;
+        if (la < rb) {
+            ra = ra * (rb - la) / rb;
+            rb = rb - la;
+            dissolve_time += la;
             ++i;
+            la = i == j ? ra : plates.a[order[i]];
+            lb = i == j ? rb : plates.b[order[i]];
         } else {
-            v[i].b = v[i].b * (v[i].a - v[j].b) / v[i].a;
-            v[i].a = v[i].a - v[j].b;
-            dissolve_time += v[j].b;
+            lb = lb * (la - rb) / la;
+            la = la - rb;
+            dissolve_time += rb;
             --j;
-
+            ra = i == j ? la : plates.a[order[j]];
+            rb = i == j ? lb : plates.b[order[j]];
+            // in case is both dissolved in the same time
+            if (la == 0) {
+                ++i;
+                la = i == j ? ra : plates.a[order[i]];
+                lb = i == j ? rb : plates.b[order[i]];
+            }
         }
-        // in case is both dissolved in the same time
-        if (v[i].a == 0) ++i;
-        if (v[j].b == 0) --j;
     }
 
     // 1 plate left
     if (i == j) {
-        dissolve_time += v[i].a * v[i].b / (v[i].a + v[i].b);
+        dissolve_time += la * lb / (la + lb);
     }
 
     return dissolve_time;
 }
 
-int main() {
+#ifdef __AVX2__
+// The same for 4 orders at once, one order per lane, all the state is in registers:
+// i and j are 64-bit lanes, the next plates are loaded by gathers, so there are
+// no branches on la < rb (it's random, such a branch is mispredicted half of the time).
+// orders + offsets[k] is the order of lane k. Results are bit-exact with DissolveTime.
+// A step is a chain of a division and two dependent gathers, so DissolveTimes
+// runs two DissolveLanes at once to overlap their latencies.
+class DissolveLanes {
+public:
+    DissolveLanes(const Plates& plates, const int* orders, const long long offsets[4])
+        : plates(plates)
+        , orders(orders)
+        , offset(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets)))
+    {
+        i = _mm256_setzero_si256();
+        j = _mm256_set1_epi64x(plates.size() - 1);
+        load(i, la, lb);
+        load(j, ra, rb);
+        active = _mm256_castsi256_pd(_mm256_cmpgt_epi64(j, i));
+        time = _mm256_setzero_pd();
+        finished = last_plate(_mm256_castsi256_pd(_mm256_cmpeq_epi64(i, j)), la, lb);
+    }
+
+    bool done() const {
+        return _mm256_movemask_pd(active) == 0;
+    }
+
+    void step() {
+        const __m256d left_first = _mm256_cmp_pd(la, rb, _CMP_LT_OQ);
+        time = _mm256_add_pd(time, _mm256_and_pd(active, _mm256_blendv_pd(rb, la, left_first)));
+        // left dissolved earlier: the right plate loses la of its b, ra = ra * (rb - la) / rb,
+        // otherwise the left one loses rb of its a, lb = lb * (la - rb) / la: one division for both
+        const __m256d quotient = _mm256_div_pd(
+            _mm256_blendv_pd(_mm256_mul_pd(lb, _mm256_sub_pd(la, rb)), _mm256_mul_pd(ra, _mm256_sub_pd(rb, la)), left_first),
+            _mm256_blendv_pd(la, rb, left_first));
+        ra = _mm256_blendv_pd(ra, quotient, left_first);
+        rb = _mm256_blendv_pd(rb, _mm256_sub_pd(rb, la), left_first);
+        lb = _mm256_blendv_pd(quotient, lb, left_first);
+        la = _mm256_blendv_pd(_mm256_sub_pd(la, rb), la, left_first);
+
+        // masks are all ones, so i - mask is ++i
+        const __m256i active_left = _mm256_castpd_si256(_mm256_and_pd(active, left_first));
+        const __m256i active_right = _mm256_castpd_si256(_mm256_andnot_pd(left_first, active));
+        // in case is both dissolved in the same time
+        const __m256i both = _mm256_and_si256(active_right, _mm256_castpd_si256(_mm256_cmp_pd(la, _mm256_setzero_pd(), _CMP_EQ_OQ)));
+        i = _mm256_sub_epi64(_mm256_sub_epi64(i, active_left), both);
+        j = _mm256_add_epi64(j, active_right);
+
+        // new plate of the moved side; for both-moved lanes it's the right one, the left one is loaded below
+        __m256d a, b;
+        load(_mm256_blendv_epi8(j, i, active_left), a, b);
+        const __m256d still_active = _mm256_and_pd(active, _mm256_castsi256_pd(_mm256_cmpgt_epi64(j, i)));
+        // lanes where i == j now: the last plate is the right one if left moved, the left one if right
+        // moved, or the new one if both moved
+        const __m256d last = _mm256_andnot_pd(still_active, _mm256_and_pd(active, _mm256_castsi256_pd(_mm256_cmpeq_epi64(i, j))));
+        const __m256d both_pd = _mm256_castsi256_pd(both);
+        finished = _mm256_add_pd(finished, last_plate(last,
+            _mm256_blendv_pd(_mm256_blendv_pd(la, ra, left_first), a, both_pd),
+            _mm256_blendv_pd(_mm256_blendv_pd(lb, rb, left_first), b, both_pd)));
+
+        const __m256d new_left = _mm256_and_pd(still_active, left_first);
+        const __m256d new_right = _mm256_andnot_pd(left_first, still_active);
+        la = _mm256_blendv_pd(la, a, new_left);
+        lb = _mm256_blendv_pd(lb, b, new_left);
+        ra = _mm256_blendv_pd(ra, a, new_right);
+        rb = _mm256_blendv_pd(rb, b, new_right);
+        const __m256d new_both = _mm256_and_pd(still_active, both_pd);
+        if (_mm256_movemask_pd(new_both) != 0) {
+            __m256d both_a, both_b;
+            load(i, both_a, both_b);
+            la = _mm256_blendv_pd(la, both_a, new_both);
+            lb = _mm256_blendv_pd(lb, both_b, new_both);
+        }
+        active = still_active;
+    }
+
+    void result(double out[4]) const {
+        _mm256_storeu_pd(out, _mm256_add_pd(time, finished));
+    }
+
+private:
+    void load(__m256i position, __m256d& a, __m256d& b) const {
+        // masked gathers with all lanes on: the unmasked ones make gcc warn about an uninitialized source
+        const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        const __m128i plate = _mm256_i64gather_epi32(orders, _mm256_add_epi64(offset, position), 4);
+        a = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), plates.a.data(), plate, all, 8);
+        b = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), plates.b.data(), plate, all, 8);
+    }
+
+    // a * b / (a + b) where mask is set
+    static __m256d last_plate(__m256d mask, __m256d a, __m256d b) {
+        return _mm256_and_pd(mask, _mm256_div_pd(_mm256_mul_pd(a, b), _mm256_add_pd(a, b)));
+    }
+
+    const Plates& plates;
+    const int* orders;
+    const __m256i offset;
+    __m256i i, j;
+    __m256d la, lb, ra, rb;
+    __m256d active, time, finished;
+};
+#endif
+
+// orders[k * N, (k + 1) * N) is the k-th order, times[k] is its dissolve time
+std::vector<double> DissolveTimes(const Plates& plates, const std::vector<int>& orders) {
+    const int n = plates.size();
+    const size_t count = orders.size() / n;
+    std::vector<double> times(count);
+
+    const auto score = [&](size_t first, size_t last) {
+        size_t k = first;
+#ifdef __AVX2__
+        const auto offsets = [n](size_t first) {
+            return std::array<long long, 4>{
+                static_cast<long long>(first * n), static_cast<long long>((first + 1) * n),
+                static_cast<long long>((first + 2) * n), static_cast<long long>((first + 3) * n)};
+        };
+        for (; k + 8 <= last; k += 8) {
+            DissolveLanes x(plates, orders.data(), offsets(k).data());
+            DissolveLanes y(plates, orders.data(), offsets(k + 4).data());
+            while (!x.done() || !y.done()) {
+                x.step();
+                y.step();
+            }
+            x.result(&times[k]);
+            y.result(&times[k + 4]);
+        }
+#endif
+        for (; k != last; ++k) {
+            times[k] = DissolveTime(plates, &orders[k * n]);
+        }
+    };
+
+    // at least 256 orders per thread
+    const size_t block_count = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count / 256));
+    std::vector<std::future<void>> blocks;
+    for (size_t block = 1; block < block_count; ++block) {
+        blocks.push_back(std::async(std::launch::async, score, count * block / block_count, count * (block + 1) / block_count));
+    }
+    score(0, count / block_count);
+    for (auto& block : blocks) {
+        block.get();
+    }
+    return times;
+}
+
+// Hill climbing over swaps of two plates starting from the greedy order:
+// all N * (N - 1) / 2 swaps are scored at once, the best one is taken while it improves.
+// Returns the best order found and prints every improvement.
+std::vector<int> LocalSearch(const Plates& plates, std::vector<int> order, double time) {
+    const int n = plates.size();
+    while (true) {
+        std::vector<int> candidates;
+        std::vector<std::pair<int, int>> swaps;
+        for (int x = 0; x < n; ++x) {
+            for (int y = x + 1; y < n; ++y) {
+                swaps.emplace_back(x, y);
+                candidates.insert(candidates.end(), order.begin(), order.end());
+                std::swap(candidates[candidates.size() - n + x], candidates[candidates.size() - n + y]);
+            }
+        }
+        if (swaps.empty()) {
+            return order;
+        }
+        const std::vector<double> times = DissolveTimes(plates, candidates);
+        const size_t best = std::max_element(times.begin(), times.end()) - times.begin();
+        // 1e-9 for rounding errors
+        if (times[best] <= time + 1e-9) {
+            return order;
+        }
+        std::cerr << "swap " << swaps[best].first << " " << swaps[best].second << ": " << time << " -> " << times[best] << std::endl;
+        std::swap(order[swaps[best].first], order[swaps[best].second]);
+        time = times[best];
+    }
+}
+
+void Verify(const Plates& plates, const std::vector<int>& greedy) {
+    const int n = plates.size();
+    const double greedy_time = DissolveTime(plates, greedy.data());
+    std::cerr << std::setprecision(6) << std::fixed << "greedy a/b: " << greedy_time << std::endl;
+
+    std::vector<int> by_difference = greedy;
+    std::sort(by_difference.begin(), by_difference.end(), [&plates](int lhs, int rhs) {
+        return plates.a[lhs] - plates.b[lhs] > plates.a[rhs] - plates.b[rhs];
+    });
+    std::cerr << "greedy a-b: " << DissolveTime(plates, by_difference.data()) << std::endl;
+
+    const std::vector<int> improved = LocalSearch(plates, greedy, greedy_time);
+    if (improved == greedy) {
+        std::cerr << "no swap of two plates improves the greedy order" << std::endl;
+    }
+
+    if (n <= 8) {
+        std::vector<int> permutation(n);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::vector<int> all;
+        do {
+            all.insert(all.end(), permutation.begin(), permutation.end());
+        } while (std::next_permutation(permutation.begin(), permutation.end()));
+        const std::vector<double> times = DissolveTimes(plates, all);
+        std::cerr << "best of all " << times.size() << " orders: " << *std::max_element(times.begin(), times.end()) << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
     int N;
     std::cin >> N;
 
-    std::vector<plate> v;
-
+    Plates plates;
     double a, b;
     for (int i = 0; i != N; ++i) {
         std::cin >> a >> b;
-        v.emplace_back(a, b, i + 1);
+        plates.a.push_back(a);
+        plates.b.push_back(b);
     }
 
-    auto cmp = [](const plate& lhs, const plate& rhs ) {
-       return lhs.a / lhs.b > rhs.a / rhs.b;
+    std::vector<int> order(N);
+    std::iota(order.begin(), order.end(), 0);
+
+    auto cmp = [&plates](int lhs, int rhs) {
+       return plates.a[lhs] / plates.b[lhs] > plates.a[rhs] / plates.b[rhs];
     };
 
-    // auto cmp = [](const plate& lhs, const plate& rhs ) {
-    //    return lhs.a - lhs.b > rhs.a - rhs.b;
+    // auto cmp = [&plates](int lhs, int rhs) {
+    //    return plates.a[lhs] - plates.b[lhs] > plates.a[rhs] - plates.b[rhs];
     // };
 
-    std::sort(v.begin(), v.end(), cmp);
+    std::sort(order.begin(), order.end(), cmp);
 
     std::cout << std::setprecision(3) << std::fixed;
-    std::cout << run(v) << std::endl;
-    for (const auto& p : v) {
-        std::cout << p.idx << " ";
+    std::cout << DissolveTime(plates, order.data()) << std::endl;
+    for (const int idx : order) {
+        std::cout << idx + 1 << " ";
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--verify") == 0) {
+        std::cout << std::endl;
+        Verify(plates, order);
     }
 }
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+// Buffered input and output over a file descriptor.
+//
+// std::cin >> string allocates a string and goes through locale and sentry
+// on every token, std::endl flushes every line: at millions of operations
+// this is slower than the persistent structure itself.
+// Here the input is read by read(2) in blocks of BUFFER_SIZE bytes and
+// numbers are parsed by hand; the output is collected in a buffer and
+// written when it's full and once at the end.
+
+class FastReader {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+    explicit FastReader(int fd = STDIN_FILENO)
+        : fd(fd)
+    {
+    }
+
+    FastReader(const FastReader&) = delete;
+    FastReader& operator=(const FastReader&) = delete;
+
+    // skips whitespace, returns the next byte without consuming it, 0 at the end of input
+    char peek() {
+        while (true) {
+            if (position == size && !refill()) {
+                return 0;
+            }
+            if (static_cast<unsigned char>(buffer[position]) > ' ') {
+                return buffer[position];
+            }
+            ++position;
+        }
+    }
+
+    // skips whitespace and consumes the next byte, 0 at the end of input
+    char get() {
+        const char c = peek();
+        if (c != 0) {
+            ++position;
+        }
+        return c;
+    }
+
+    // consumes the next byte of the current word, 0 if the word has ended
+    char get_in_word() {
+        if ((position != size || refill()) && static_cast<unsigned char>(buffer[position]) > ' ') {
+            return buffer[position++];
+        }
+        return 0;
+    }
+
+    // skips the rest of the current word
+    void skip_word() {
+        while ((position != size || refill()) && static_cast<unsigned char>(buffer[position]) > ' ') {
+            ++position;
+        }
+    }
+
+    // decimal number with an optional minus, no overflow checks
+    template<typename Int = int>
+    Int read_int() {
+        const bool negative = peek() == '-';
+        if (negative) {
+            ++position;
+        }
+        Int result = 0;
+        while ((position != size || refill()) && static_cast<unsigned char>(buffer[position] - '0') < 10) {
+            result = result * 10 + (buffer[position++] - '0');
+        }
+        return negative ? -result : result;
+    }
+
+    // back to the start of the input, false if it's not a regular file (pipe, terminal)
+    bool rewind() {
+        if (lseek(fd, 0, SEEK_SET) != 0) {
+            return false;
+        }
+        position = 0;
+        size = 0;
+        return true;
+    }
+
+    // raw bytes, returns how many were read (less than count only at the end of input)
+    size_t read(void* data, size_t count) {
+        char* out = static_cast<char*>(data);
+        size_t done = 0;
+        while (done != count && (position != size || refill())) {
+            const size_t chunk = std::min(count - done, size - position);
+            std::memcpy(out + done, buffer + position, chunk);
+            position += chunk;
+            done += chunk;
+        }
+        return done;
+    }
+
+private:
+    bool refill() {
+        position = 0;
+        size = 0;
+        ssize_t got;
+        do {
+            got = ::read(fd, buffer, BUFFER_SIZE);
+        } while (got < 0 && errno == EINTR);
+        if (got <= 0) {
+            return false;
+        }
+        size = got;
+        return true;
+    }
+
+    const int fd;
+    size_t position = 0;
+    size_t size = 0;
+    char buffer[BUFFER_SIZE];
+};
+
+
+class FastWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+    explicit FastWriter(int fd = STDOUT_FILENO)
+        : fd(fd)
+    {
+    }
+
+    FastWriter(const FastWriter&) = delete;
+    FastWriter& operator=(const FastWriter&) = delete;
+
+    ~FastWriter() {
+        flush();
+    }
+
+    void write_char(char c) {
+        if (size == BUFFER_SIZE) {
+            flush();
+        }
+        buffer[size++] = c;
+    }
+
+    void write_int(long long value) {
+        // 20 digits and a minus
+        if (size + 21 > BUFFER_SIZE) {
+            flush();
+        }
+        unsigned long long rest = value;
+        if (value < 0) {
+            buffer[size++] = '-';
+            rest = -rest;
+        }
+        char digits[20];
+        int length = 0;
+        do {
+            digits[length++] = '0' + rest % 10;
+            rest /= 10;
+        } while (rest != 0);
+        while (length != 0) {
+            buffer[size++] = digits[--length];
+        }
+    }
+
+    void write(const void* data, size_t count) {
+        const char* in = static_cast<const char*>(data);
+        while (count != 0) {
+            if (size == BUFFER_SIZE) {
+                flush();
+            }
+            const size_t chunk = std::min(count, BUFFER_SIZE - size);
+            std::memcpy(buffer + size, in, chunk);
+            size += chunk;
+            in += chunk;
+            count -= chunk;
+        }
+    }
+
+    void flush() {
+        size_t done = 0;
+        while (done != size) {
+            const ssize_t written = ::write(fd, buffer + done, size - done);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            done += written;
+        }
+        size = 0;
+    }
+
+private:
+    const int fd;
+    size_t size = 0;
+    char buffer[BUFFER_SIZE];
+};
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "aho_corasick.h"
+#include "prefix_func.h"
+
+using namespace std;
+
+// Aho-Corasick against pref_func run once per pattern (pattern + '#' + text).
+// Patterns are substrings of the text, so there are matches.
+// pref_func is O(patterns * text), so it gets only the first BASELINE_WORK / patterns
+// bytes; speed is in MB of text per second for all patterns together.
+// usage: ./aho_bench [text_megabytes]
+
+constexpr size_t BASELINE_WORK = 1 << 28;
+constexpr size_t CHUNK_SIZE = 1 << 16;
+
+string GenerateText(mt19937& generator, size_t size, int alphabet) {
+    string text(size, 'a');
+    for (char& c : text) {
+        c = 'a' + uniform_int_distribution(0, alphabet - 1)(generator);
+    }
+    return text;
+}
+
+vector<string> GeneratePatterns(mt19937& generator, const string& text, int count, int min_length, int max_length) {
+    vector<string> patterns;
+    for (int i = 0; i < count; ++i) {
+        const int length = uniform_int_distribution(min_length, max_length)(generator);
+        const size_t start = uniform_int_distribution<size_t>(0, text.size() - length)(generator);
+        patterns.push_back(text.substr(start, length));
+    }
+    return patterns;
+}
+
+template<typename Function>
+long long MeasureSpeed(const string& name, size_t bytes, Function function) {
+    const auto start = chrono::steady_clock::now();
+    const long long matches = function();
+    const chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+    cout << setw(40) << left << name << fixed << setprecision(2)
+         << bytes / seconds.count() / (1 << 20) << " MB/s, " << matches << " matches" << endl;
+    return matches;
+}
+
+void Bench(const string& text, int alphabet, int pattern_count) {
+    mt19937 generator(pattern_count);
+    const vector<string> patterns = GeneratePatterns(generator, text, pattern_count, 5, 20);
+    const AhoCorasick automaton(patterns);
+    cout << pattern_count << " patterns, alphabet " << alphabet << ": " << automaton.StateCount() << " states, "
+         << automaton.MemoryUsage() / 1024 << " KB" << endl;
+
+    const string_view baseline_text = string_view(text).substr(0, BASELINE_WORK / pattern_count);
+    const long long expected = MeasureSpeed("pref_func per pattern", baseline_text.size(), [&] {
+        long long matches = 0;
+        for (const string& pattern : patterns) {
+            string s = pattern + '#';
+            s += baseline_text;
+            const vector<int> pi = pref_func(s);
+            matches += count(pi.begin(), pi.end(), static_cast<int>(pattern.size()));
+        }
+        return matches;
+    });
+    const long long found = MeasureSpeed("AhoCorasick, same text", baseline_text.size(), [&] {
+        long long matches = 0;
+        automaton.Scan(AhoCorasick::ROOT, baseline_text, [&](int, size_t) { ++matches; });
+        return matches;
+    });
+    if (found != expected) {
+        cout << "WRONG RESULT" << endl;
+    }
+
+    const long long whole = MeasureSpeed("AhoCorasick, whole text", text.size(), [&] {
+        long long matches = 0;
+        automaton.Scan(AhoCorasick::ROOT, text, [&](int, size_t) { ++matches; });
+        return matches;
+    });
+    const long long streamed = MeasureSpeed("AhoCorasickStream, 64 KB chunks", text.size(), [&] {
+        long long matches = 0;
+        AhoCorasickStream stream(automaton);
+        for (size_t begin = 0; begin < text.size(); begin += CHUNK_SIZE) {
+            stream.Scan(string_view(text).substr(begin, CHUNK_SIZE), [&](int, size_t) { ++matches; });
+        }
+        return matches;
+    });
+    if (streamed != whole) {
+        cout << "WRONG RESULT" << endl;
+    }
+    cout << endl;
+}
+
+
+int main(int argc, char* argv[]) {
+    const size_t text_size = (argc > 1 ? stoul(argv[1]) : 64) << 20;
+
+    for (const int alphabet : {4, 26}) {
+        mt19937 generator(alphabet);
+        const string text = GenerateText(generator, text_size, alphabet);
+        for (const int pattern_count : {100, 1'000, 10'000}) {
+            Bench(text, alphabet, pattern_count);
+        }
+    }
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Aho-Corasick automaton: finds all occurrences of many patterns in one pass over the text.
+//
+// The trie is built with pointer-like nodes, then flattened to arrays indexed by
+// state number, states are numbered in BFS order (by depth):
+//   - states of depth < DENSE_DEPTH (the root and its children) have a full row of
+//     256 transitions, already resolved through suffix links. Almost every step of
+//     the text goes through these states, and they take one memory access per byte;
+//   - deeper states keep only their own edges (label + target, one after another
+//     in two flat arrays) and the suffix link, a missing edge follows the suffix link
+//     until a dense state is reached. 256 transitions for every deep state would be
+//     1 KB per state, thousands of patterns wouldn't fit in cache.
+// For every state the nearest state (itself or by suffix links) where a pattern
+// ends is precomputed (output link), so states without matches cost one check.
+//
+// The text may come in chunks: Scan takes the state after the previous chunk
+// and returns the state after this one, AhoCorasickStream keeps it.
+
+class AhoCorasick {
+public:
+    static constexpr int DENSE_DEPTH = 2;
+    static constexpr uint32_t ROOT = 0;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    explicit AhoCorasick(const std::vector<std::string>& patterns) {
+        Build(patterns);
+    }
+
+    size_t PatternCount() const {
+        return pattern_lengths_.size();
+    }
+
+    size_t PatternLength(int pattern) const {
+        return pattern_lengths_[pattern];
+    }
+
+    size_t StateCount() const {
+        return fail_.size();
+    }
+
+    size_t MemoryUsage() const {
+        return dense_.size() * sizeof(uint32_t)
+            + (fail_.size() + edge_begin_.size() + output_.size() + dict_.size() + match_begin_.size()) * sizeof(uint32_t)
+            + labels_.size() + targets_.size() * sizeof(uint32_t) + matches_.size() * sizeof(int);
+    }
+
+    uint32_t Next(uint32_t state, unsigned char c) const {
+        while (state >= dense_count_) {
+            for (uint32_t edge = edge_begin_[state]; edge != edge_begin_[state + 1]; ++edge) {
+                if (labels_[edge] == c) {
+                    return targets_[edge];
+                }
+            }
+            state = fail_[state];
+        }
+        return dense_[state * 256 + c];
+    }
+
+    // on_match(pattern, end) for every occurrence, end is the index after
+    // the last byte of the occurrence in the chunk (may be less than the
+    // pattern length if the occurrence started in a previous chunk)
+    template<typename OnMatch>
+    uint32_t Scan(uint32_t state, std::string_view chunk, OnMatch on_match) const {
+        for (size_t i = 0; i != chunk.size(); ++i) {
+            state = Next(state, static_cast<unsigned char>(chunk[i]));
+            for (uint32_t out = output_[state]; out != NONE; out = dict_[out]) {
+                for (uint32_t match = match_begin_[out]; match != match_begin_[out + 1]; ++match) {
+                    on_match(matches_[match], i + 1);
+                }
+            }
+        }
+        return state;
+    }
+
+private:
+    struct BuildNode {
+        std::vector<std::pair<unsigned char, uint32_t>> edges;
+        std::vector<int> patterns;
+        uint32_t fail = ROOT;
+        int depth = 0;
+
+        uint32_t Child(unsigned char c) const {
+            for (const auto& [label, target] : edges) {
+                if (label == c) {
+                    return target;
+                }
+            }
+            return NONE;
+        }
+    };
+
+    void Build(const std::vector<std::string>& patterns) {
+        std::vector<BuildNode> trie(1);
+        for (int pattern = 0; pattern != static_cast<int>(patterns.size()); ++pattern) {
+            uint32_t node = ROOT;
+            for (const char ch : patterns[pattern]) {
+                const unsigned char c = ch;
+                uint32_t child = trie[node].Child(c);
+                if (child == NONE) {
+                    child = trie.size();
+                    trie[node].edges.emplace_back(c, child);
+                    trie.emplace_back();
+                    trie[child].depth = trie[node].depth + 1;
+                }
+                node = child;
+            }
+            trie[node].patterns.push_back(pattern);
+            pattern_lengths_.push_back(patterns[pattern].size());
+        }
+
+        // BFS: suffix links and the new numbers of the nodes
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> number(trie.size());
+        std::queue<uint32_t> queue;
+        queue.push(ROOT);
+        while (!queue.empty()) {
+            const uint32_t node = queue.front();
+            queue.pop();
+            number[node] = order.size();
+            order.push_back(node);
+            for (const auto& [c, child] : trie[node].edges) {
+                if (node != ROOT) {
+                    uint32_t suffix = trie[node].fail;
+                    while (suffix != ROOT && trie[suffix].Child(c) == NONE) {
+                        suffix = trie[suffix].fail;
+                    }
+                    const uint32_t next = trie[suffix].Child(c);
+                    trie[child].fail = next != NONE ? next : ROOT;
+                }
+                queue.push(child);
+            }
+        }
+
+        const size_t state_count = trie.size();
+        dense_count_ = 0;
+        while (dense_count_ != state_count && trie[order[dense_count_]].depth < DENSE_DEPTH) {
+            ++dense_count_;
+        }
+
+        fail_.resize(state_count);
+        edge_begin_.assign(state_count + 1, 0);
+        match_begin_.assign(state_count + 1, 0);
+        output_.resize(state_count);
+        dict_.resize(state_count);
+        for (uint32_t state = 0; state != state_count; ++state) {
+            const BuildNode& node = trie[order[state]];
+            fail_[state] = number[node.fail];
+            edge_begin_[state] = labels_.size();
+            if (state >= dense_count_) {
+                for (const auto& [c, child] : node.edges) {
+                    labels_.push_back(c);
+                    targets_.push_back(number[child]);
+                }
+            }
+            match_begin_[state] = matches_.size();
+            matches_.insert(matches_.end(), node.patterns.begin(), node.patterns.end());
+        }
+        edge_begin_[state_count] = labels_.size();
+        match_begin_[state_count] = matches_.size();
+
+        // suffix links point to smaller depth, so they are ready in BFS order
+        for (uint32_t state = 0; state != state_count; ++state) {
+            const uint32_t suffix_output = state == ROOT ? NONE : output_[fail_[state]];
+            dict_[state] = suffix_output;
+            output_[state] = match_begin_[state] != match_begin_[state + 1] ? state : suffix_output;
+        }
+
+        // full rows of the dense states, their suffix links are dense too
+        dense_.assign(dense_count_ * 256, ROOT);
+        for (uint32_t state = 0; state != dense_count_; ++state) {
+            if (state != ROOT) {
+                std::copy(dense_.begin() + fail_[state] * 256, dense_.begin() + (fail_[state] + 1) * 256,
+                          dense_.begin() + state * 256);
+            }
+            for (const auto& [c, child] : trie[order[state]].edges) {
+                dense_[state * 256 + c] = number[child];
+            }
+        }
+    }
+
+    uint32_t dense_count_ = 0;
+    std::vector<uint32_t> dense_;
+    std::vector<uint32_t> fail_;
+    std::vector<uint32_t> edge_begin_;
+    std::vector<unsigned char> labels_;
+    std::vector<uint32_t> targets_;
+    // output_[state] - first state with matches on the suffix link path (or state itself),
+    // dict_[state] - the next one after state
+    std::vector<uint32_t> output_;
+    std::vector<uint32_t> dict_;
+    std::vector<uint32_t> match_begin_;
+    std::vector<int> matches_;
+    std::vector<size_t> pattern_lengths_;
+};
+
+
+// Scanning of a text that comes in chunks (from a socket, a file read by blocks),
+// occurrences on the chunk boundaries are found too.
+class AhoCorasickStream {
+public:
+    explicit AhoCorasickStream(const AhoCorasick& automaton)
+        : automaton_(automaton)
+    {
+    }
+
+    // on_match(pattern, end), end is the position after the occurrence from the start of the stream
+    template<typename OnMatch>
+    void Scan(std::string_view chunk, OnMatch on_match) {
+        const size_t offset = position_;
+        state_ = automaton_.Scan(state_, chunk, [&](int pattern, size_t end) {
+            on_match(pattern, offset + end);
+        });
+        position_ += chunk.size();
+    }
+
+    size_t Position() const {
+        return position_;
+    }
+
+    void Reset() {
+        state_ = AhoCorasick::ROOT;
+        position_ = 0;
+    }
+
+private:
+    const AhoCorasick& automaton_;
+    uint32_t state_ = AhoCorasick::ROOT;
+    size_t position_ = 0;
+};
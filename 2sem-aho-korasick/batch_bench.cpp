@@ -0,0 +1,92 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "batch_borders.h"
+#include "prefix_func.h"
+#include "profile.h"
+
+using namespace std;
+
+// π for millions of short strings: pref_func per string (a std::string and
+// a vector per call) against BatchPrefixFunction into one buffer, 1 and all threads.
+// A quarter of the strings are powers of a short string.
+// usage: ./batch_bench [string_count]
+
+PackedStrings GenerateStrings(mt19937& generator, int count, int max_length) {
+    PackedStrings strings;
+    strings.Reserve(count, static_cast<size_t>(count) * (max_length + 1) / 2);
+    string s;
+    for (int i = 0; i < count; ++i) {
+        const int length = uniform_int_distribution(1, max_length)(generator);
+        const int period = uniform_int_distribution(0, 3)(generator) == 0
+            ? uniform_int_distribution(1, 4)(generator)
+            : length;
+        s.resize(length);
+        for (int j = 0; j < length; ++j) {
+            s[j] = j < period ? 'a' + uniform_int_distribution(0, 2)(generator) : s[j - period];
+        }
+        strings.Add(s);
+    }
+    return strings;
+}
+
+long long Checksum(const vector<int>& values) {
+    long long checksum = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        checksum += values[i] * static_cast<long long>(i % 7 + 1);
+    }
+    return checksum;
+}
+
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? stoi(argv[1]) : 5'000'000;
+    mt19937 generator;
+    const PackedStrings strings = GenerateStrings(generator, count, 64);
+    cout << strings.size() << " strings, " << strings.ByteCount() << " bytes" << endl;
+
+    vector<int> expected(strings.ByteCount());
+    {
+        LOG_DURATION("pref_func per string");
+        for (size_t i = 0; i < strings.size(); ++i) {
+            string s(strings[i]);
+            const vector<int> pi = pref_func(s);
+            copy(pi.begin(), pi.end(), expected.begin() + strings.Offset(i));
+        }
+    }
+
+    vector<int> out(strings.ByteCount());
+    {
+        LOG_DURATION("BatchPrefixFunction, 1 thread");
+        BatchPrefixFunction(strings, out.data(), 1);
+    }
+    cout << (out == expected ? "" : "WRONG RESULT\n");
+    {
+        LOG_DURATION("BatchPrefixFunction");
+        BatchPrefixFunction(strings, out.data());
+    }
+    cout << (out == expected ? "" : "WRONG RESULT\n");
+
+    {
+        LOG_DURATION("BatchZFunction");
+        BatchZFunction(strings, out.data());
+    }
+    cout << "z checksum " << Checksum(out) << endl;
+
+    vector<int> periods;
+    {
+        LOG_DURATION("BatchMinimalPeriods");
+        periods = BatchMinimalPeriods(strings);
+    }
+    int powers = 0;
+    for (size_t i = 0; i < strings.size(); ++i) {
+        const size_t length = strings[i].size();
+        if (periods[i] != MinimalPeriod(expected.data() + strings.Offset(i), length)) {
+            cout << "WRONG RESULT" << endl;
+            break;
+        }
+        powers += IsPower(expected.data() + strings.Offset(i), length);
+    }
+    cout << powers << " strings are powers of a shorter string" << endl;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Prefix function and Z-function for millions of short strings at once.
+//
+// pref_func(std::string&) allocates a vector for every string; here the strings
+// are packed in one buffer (PackedStrings: bytes + offsets) and the values of
+// string i are written to out[offsets[i], offsets[i + 1]) of one output buffer
+// allocated once. Threads get ranges of strings with equal number of bytes
+// (not of strings: lengths may differ a lot).
+//
+// Periods follow from π: the minimal period of s is n - π[n - 1],
+// s is a power of a shorter string iff the minimal period divides n.
+
+class PackedStrings {
+public:
+    void Add(std::string_view s) {
+        bytes_.insert(bytes_.end(), s.begin(), s.end());
+        offsets_.push_back(bytes_.size());
+    }
+
+    void Reserve(size_t string_count, size_t byte_count) {
+        offsets_.reserve(string_count + 1);
+        bytes_.reserve(byte_count);
+    }
+
+    size_t size() const {
+        return offsets_.size() - 1;
+    }
+
+    size_t ByteCount() const {
+        return bytes_.size();
+    }
+
+    std::string_view operator[](size_t i) const {
+        return std::string_view(bytes_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    // offset of string i in the bytes and in the output of the batch functions
+    size_t Offset(size_t i) const {
+        return offsets_[i];
+    }
+
+private:
+    std::vector<char> bytes_;
+    std::vector<size_t> offsets_ = {0};
+};
+
+
+// π of s to out[0, s.size()), no allocations
+inline void PrefixFunction(std::string_view s, int* pi) {
+    if (s.empty()) {
+        return;
+    }
+    pi[0] = 0;
+    for (size_t i = 1; i != s.size(); ++i) {
+        int k = pi[i - 1];
+        while (k > 0 && s[i] != s[k]) {
+            k = pi[k - 1];
+        }
+        if (s[i] == s[k]) {
+            ++k;
+        }
+        pi[i] = k;
+    }
+}
+
+// z[i] - the length of the longest common prefix of s and s[i..], z[0] = n
+inline void ZFunction(std::string_view s, int* z) {
+    const int n = s.size();
+    if (n == 0) {
+        return;
+    }
+    z[0] = n;
+    // [left, right) - the rightmost segment that matches a prefix
+    int left = 0;
+    int right = 0;
+    for (int i = 1; i < n; ++i) {
+        int k = i < right ? std::min(right - i, z[i - left]) : 0;
+        while (i + k < n && s[k] == s[i + k]) {
+            ++k;
+        }
+        z[i] = k;
+        if (i + k > right) {
+            left = i;
+            right = i + k;
+        }
+    }
+}
+
+inline int MinimalPeriod(const int* pi, size_t length) {
+    return length == 0 ? 0 : length - pi[length - 1];
+}
+
+// s = t^k for some k >= 2
+inline bool IsPower(const int* pi, size_t length) {
+    const size_t period = MinimalPeriod(pi, length);
+    return period < length && length % period == 0;
+}
+
+
+namespace BatchDetail {
+
+    // [first, last) strings of every thread, about ByteCount() / threads bytes each
+    template<typename Fn>
+    void ForEachStringRange(const PackedStrings& strings, size_t thread_count, Fn fn) {
+        const size_t count = strings.size();
+        thread_count = std::max<size_t>(1, std::min(thread_count, count));
+        std::vector<size_t> bounds(thread_count + 1, count);
+        bounds[0] = 0;
+        size_t string = 0;
+        for (size_t thread = 1; thread < thread_count; ++thread) {
+            const size_t target = strings.ByteCount() * thread / thread_count;
+            while (string < count && strings.Offset(string) < target) {
+                ++string;
+            }
+            bounds[thread] = string;
+        }
+
+        std::vector<std::future<void>> threads;
+        for (size_t thread = 1; thread < thread_count; ++thread) {
+            threads.push_back(std::async(std::launch::async, fn, bounds[thread], bounds[thread + 1]));
+        }
+        fn(bounds[0], bounds[1]);
+        for (auto& thread : threads) {
+            thread.get();
+        }
+    }
+
+    inline size_t DefaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+}
+
+
+// out must have strings.ByteCount() elements
+inline void BatchPrefixFunction(const PackedStrings& strings, int* out,
+                                size_t thread_count = BatchDetail::DefaultThreadCount()) {
+    BatchDetail::ForEachStringRange(strings, thread_count, [&strings, out](size_t first, size_t last) {
+        for (size_t i = first; i != last; ++i) {
+            PrefixFunction(strings[i], out + strings.Offset(i));
+        }
+    });
+}
+
+inline void BatchZFunction(const PackedStrings& strings, int* out,
+                           size_t thread_count = BatchDetail::DefaultThreadCount()) {
+    BatchDetail::ForEachStringRange(strings, thread_count, [&strings, out](size_t first, size_t last) {
+        for (size_t i = first; i != last; ++i) {
+            ZFunction(strings[i], out + strings.Offset(i));
+        }
+    });
+}
+
+// minimal period of every string, π is computed in a per-thread buffer and not kept
+inline std::vector<int> BatchMinimalPeriods(const PackedStrings& strings,
+                                            size_t thread_count = BatchDetail::DefaultThreadCount()) {
+    std::vector<int> periods(strings.size());
+    BatchDetail::ForEachStringRange(strings, thread_count, [&strings, &periods](size_t first, size_t last) {
+        std::vector<int> pi;
+        for (size_t i = first; i != last; ++i) {
+            const std::string_view s = strings[i];
+            if (pi.size() < s.size()) {
+                pi.resize(s.size());
+            }
+            PrefixFunction(s, pi.data());
+            periods[i] = MinimalPeriod(pi.data(), s.size());
+        }
+    });
+    return periods;
+}
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+#include "kmp_matcher.h"
+#include "prefix_func.h"
+
+using namespace std;
+
+// Search of one pattern in a log-like text (words of lowercase letters, lines),
+// the pattern is inserted every ~64 KB.
+// pref_func on pattern + '#' + text against KmpMatcher with and without
+// the automaton and the prefilter, then KmpMatcher on a file by read and by mmap.
+// Compile with -O2 -mavx2 (or -march=native) to get the SIMD prefilter.
+// usage: ./kmp_bench [text_megabytes]
+
+const string PATTERN = "error: connection reset by peer";
+
+string GenerateLog(mt19937& generator, size_t size) {
+    string text;
+    text.reserve(size + 64);
+    while (text.size() < size) {
+        const int kind = uniform_int_distribution(0, 1023)(generator);
+        if (kind == 0) {
+            text += PATTERN;
+        } else if (kind < 100) {
+            text += '\n';
+        } else {
+            const int length = uniform_int_distribution(1, 10)(generator);
+            for (int i = 0; i < length; ++i) {
+                text += 'a' + uniform_int_distribution(0, 25)(generator);
+            }
+            text += ' ';
+        }
+    }
+    text.resize(size);
+    return text;
+}
+
+template<typename Function>
+void MeasureSpeed(const string& name, size_t bytes, Function function) {
+    const auto start = chrono::steady_clock::now();
+    const long long matches = function();
+    const chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+    cout << setw(40) << left << name << fixed << setprecision(1)
+         << bytes / seconds.count() / (1 << 20) << " MB/s, " << matches << " matches" << endl;
+}
+
+void BenchMatcher(const string& name, const string& text, KmpOptions options) {
+    MeasureSpeed(name, text.size(), [&] {
+        long long matches = 0;
+        KmpMatcher matcher(PATTERN, options);
+        matcher.Scan(text, [&](size_t) { ++matches; });
+        return matches;
+    });
+}
+
+
+int main(int argc, char* argv[]) {
+    const size_t text_size = (argc > 1 ? stoul(argv[1]) : 256) << 20;
+    mt19937 generator;
+    const string text = GenerateLog(generator, text_size);
+
+    MeasureSpeed("pref_func", text.size(), [&] {
+        string s = PATTERN + '#' + text;
+        const vector<int> pi = pref_func(s);
+        return count(pi.begin(), pi.end(), static_cast<int>(PATTERN.size()));
+    });
+    MeasureSpeed("string_view::find", text.size(), [&] {
+        long long matches = 0;
+        const string_view view = text;
+        for (size_t i = view.find(PATTERN); i != string_view::npos; i = view.find(PATTERN, i + 1)) {
+            ++matches;
+        }
+        return matches;
+    });
+    BenchMatcher("KmpMatcher, pi", text, {false, false});
+    BenchMatcher("KmpMatcher, automaton", text, {true, false});
+    BenchMatcher("KmpMatcher, pi + prefilter", text, {false, true});
+    BenchMatcher("KmpMatcher, automaton + prefilter", text, {true, true});
+
+    char path[] = "/tmp/kmp_bench_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0 || write(fd, text.data(), text.size()) != static_cast<ssize_t>(text.size())) {
+        cout << "can't write " << path << endl;
+        return 1;
+    }
+    MeasureSpeed("KmpMatcher::ScanFd", text.size(), [&] {
+        long long matches = 0;
+        lseek(fd, 0, SEEK_SET);
+        KmpMatcher matcher(PATTERN);
+        matcher.ScanFd(fd, [&](size_t) { ++matches; });
+        return matches;
+    });
+    MeasureSpeed("KmpMatcher::ScanMapped", text.size(), [&] {
+        long long matches = 0;
+        KmpMatcher matcher(PATTERN);
+        matcher.ScanMapped(fd, [&](size_t) { ++matches; });
+        return matches;
+    });
+    close(fd);
+    unlink(path);
+}
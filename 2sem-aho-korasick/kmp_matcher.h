@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "prefix_func.h"
+
+#ifdef __AVX2__
+  #include <immintrin.h>
+#endif
+
+// Search of one pattern in a text of any length that comes in chunks (grep).
+//
+// The state is the length of the matched prefix of the pattern, it is kept
+// between Scan calls, so occurrences on chunk boundaries are found.
+// A step is done by π (amortized O(1)) or, if the pattern has few distinct
+// bytes, by the full automaton: a table [state][class of byte], one lookup per
+// byte without the while loop. Bytes not in the pattern have class 0 and
+// always lead to state 0.
+//
+// Prefilter: while the state is 0, an occurrence can start only at i with
+// text[i] == pattern[0] and text[i + m - 1] == pattern[m - 1]. With AVX2 both
+// are checked for 32 positions at once and the automaton is run only from the
+// candidates; without AVX2 memchr finds the next first byte.
+// Skipping non-candidates is safe: no occurrence starts there, so the
+// state after them doesn't matter.
+//
+// The pattern must not be empty.
+
+struct KmpOptions {
+    bool automaton = true;
+    bool prefilter = true;
+};
+
+class KmpMatcher {
+public:
+    static constexpr int MAX_AUTOMATON_ALPHABET = 16;
+    static constexpr size_t MAX_AUTOMATON_SIZE = 1 << 22;
+    static constexpr size_t READ_CHUNK_SIZE = 1 << 20;
+
+    explicit KmpMatcher(std::string pattern, KmpOptions options = {})
+        : pattern_(std::move(pattern))
+        , pi_(pref_func(pattern_))
+        , prefilter_(options.prefilter)
+    {
+        if (options.automaton) {
+            BuildAutomaton();
+        }
+    }
+
+    size_t PatternLength() const {
+        return pattern_.size();
+    }
+
+    bool HasAutomaton() const {
+        return !table_.empty();
+    }
+
+    // on_match(end) for every occurrence, end is the position after it from the start of the stream
+    template<typename OnMatch>
+    void Scan(std::string_view chunk, OnMatch on_match) {
+        const char* data = chunk.data();
+        const size_t size = chunk.size();
+        const uint32_t length = pattern_.size();
+        size_t i = 0;
+        while (i < size) {
+            if (state_ == 0 && prefilter_) {
+                i = FindCandidate(data, i, size);
+                if (i == size) {
+                    break;
+                }
+            }
+            state_ = Step(state_, data[i]);
+            ++i;
+            if (state_ == length) {
+                on_match(position_ + i);
+            }
+        }
+        position_ += size;
+    }
+
+    // reads the file by READ_CHUNK_SIZE blocks, false on a read error
+    template<typename OnMatch>
+    bool ScanFd(int fd, OnMatch on_match) {
+        std::vector<char> buffer(READ_CHUNK_SIZE);
+        while (true) {
+            const ssize_t got = ::read(fd, buffer.data(), buffer.size());
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                return got == 0;
+            }
+            Scan(std::string_view(buffer.data(), got), on_match);
+        }
+    }
+
+    // maps the whole file, no copy to a user buffer; false if it can't be mapped
+    // (pipes, sockets - use ScanFd for them)
+    template<typename OnMatch>
+    bool ScanMapped(int fd, OnMatch on_match) {
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            return false;
+        }
+        if (info.st_size == 0) {
+            return true;
+        }
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        madvise(data, info.st_size, MADV_SEQUENTIAL);
+        Scan(std::string_view(static_cast<const char*>(data), info.st_size), on_match);
+        munmap(data, info.st_size);
+        return true;
+    }
+
+    size_t Position() const {
+        return position_;
+    }
+
+    void Reset() {
+        state_ = 0;
+        position_ = 0;
+    }
+
+private:
+    void BuildAutomaton() {
+        int alphabet = 0;
+        for (const char c : pattern_) {
+            uint8_t& byte_class = classes_[static_cast<unsigned char>(c)];
+            if (byte_class == 0) {
+                byte_class = ++alphabet;
+            }
+        }
+        const size_t length = pattern_.size();
+        row_size_ = alphabet + 1;
+        if (alphabet > MAX_AUTOMATON_ALPHABET || (length + 1) * row_size_ > MAX_AUTOMATON_SIZE) {
+            return;
+        }
+
+        // row of state s is the row of π[s - 1] plus the edge along the pattern
+        table_.assign((length + 1) * row_size_, 0);
+        for (size_t state = 0; state <= length; ++state) {
+            uint32_t* row = &table_[state * row_size_];
+            if (state > 0) {
+                const uint32_t* border = &table_[pi_[state - 1] * row_size_];
+                std::copy(border, border + row_size_, row);
+            }
+            if (state < length) {
+                row[classes_[static_cast<unsigned char>(pattern_[state])]] = state + 1;
+            }
+        }
+    }
+
+    uint32_t Step(uint32_t state, char c) const {
+        if (!table_.empty()) {
+            return table_[state * row_size_ + classes_[static_cast<unsigned char>(c)]];
+        }
+        while (state > 0 && (state == pattern_.size() || c != pattern_[state])) {
+            state = pi_[state - 1];
+        }
+        return c == pattern_[state] ? state + 1 : state;
+    }
+
+    // the first candidate start >= from, or a position near the end of the chunk
+    // where the check by the last byte is not possible anymore
+    size_t FindCandidate(const char* data, size_t from, size_t size) const {
+#ifdef __AVX2__
+        const size_t last_offset = pattern_.size() - 1;
+        const __m256i first = _mm256_set1_epi8(pattern_.front());
+        const __m256i last = _mm256_set1_epi8(pattern_.back());
+        size_t i = from;
+        for (; i + last_offset + 32 <= size; i += 32) {
+            const __m256i first_equal = _mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+            const __m256i last_equal = _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + last_offset)));
+            const uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(first_equal, last_equal));
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return i;
+#else
+        const void* found = std::memchr(data + from, pattern_.front(), size - from);
+        return found == nullptr ? size : static_cast<const char*>(found) - data;
+#endif
+    }
+
+    std::string pattern_;
+    std::vector<int> pi_;
+    bool prefilter_;
+    uint8_t classes_[256] = {};
+    uint32_t row_size_ = 0;
+    std::vector<uint32_t> table_;
+
+    uint32_t state_ = 0;
+    size_t position_ = 0;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+inline std::vector<int> pref_func(std::string& s) {
+    std::vector<int> pi(s.length());
+    pi[0] = 0;
+    int k;
+
+    for (int i = 1; i != s.length(); ++i) {
+        k = pi[i - 1];
+        while (k > 0 && s[i] != s[k] ) {
+            k = pi[k - 1];
+        }
+
+        if (s[i] == s[k]) {
+            ++k;
+        }
+
+        pi[i] = k;
+    }
+
+    return pi;
+
+}
+
+inline std::vector<int> string_by_pref(std::vector<int>& pi) {
+    std::vector<int> res;
+    int v = 0;
+
+    for (int i = 0; i != pi.size(); ++i) {
+        if (pi[i] == 0) {
+            res.push_back(v);
+            ++v;
+        } else {
+            int prev = res[pi[i] - 1];
+            res.push_back(prev);
+        }
+    }
+
+    return res;
+}
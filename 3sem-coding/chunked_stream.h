@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "huffman.h"
+#include "lz77.h"
+
+// Compression of a stream (file descriptor to file descriptor) by independent chunks.
+//
+// Every chunk is compressed on its own: a chunk can be decoded without the
+// previous ones, so up to thread_count chunks are compressed or decompressed
+// at once in parallel, then written in order. Compression is a bit worse than
+// for one big block (the dictionary of LZ77 and the Huffman code start anew),
+// with 1 MB chunks it's not noticeable.
+//
+// Format: "HLZ1", then chunks: method (1 byte), raw size and compressed size
+// (4 bytes each, little endian), the compressed bytes. A chunk that doesn't get
+// smaller is stored as is. LZ77_HUFFMAN is LZ77 and then Huffman over its
+// output: 4 bytes of the LZ77 size and the Huffman block.
+
+enum class Method : uint8_t {
+    STORED = 0,
+    HUFFMAN = 1,
+    LZ77 = 2,
+    LZ77_HUFFMAN = 3,
+};
+
+struct StreamOptions {
+    Method method = Method::LZ77_HUFFMAN;
+    size_t chunk_size = 1 << 20;
+    size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+};
+
+namespace StreamDetail {
+
+    constexpr char MAGIC[] = {'H', 'L', 'Z', '1'};
+    constexpr size_t HEADER_SIZE = 9;
+    // larger sizes in a header mean a corrupted stream, not an allocation of 4 GB
+    constexpr uint32_t MAX_CHUNK_SIZE = 1 << 30;
+
+    inline void AppendUint32(uint32_t value, std::string& out) {
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    inline uint32_t ReadUint32(const char* p) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    // reads up to count bytes, less only at the end of the stream; -1 on an error
+    inline ssize_t ReadFull(int fd, char* data, size_t count) {
+        size_t done = 0;
+        while (done < count) {
+            const ssize_t got = ::read(fd, data + done, count - done);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got < 0) {
+                return -1;
+            }
+            if (got == 0) {
+                break;
+            }
+            done += got;
+        }
+        return done;
+    }
+
+    inline bool WriteFull(int fd, std::string_view data) {
+        while (!data.empty()) {
+            const ssize_t written = ::write(fd, data.data(), data.size());
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written < 0) {
+                return false;
+            }
+            data.remove_prefix(written);
+        }
+        return true;
+    }
+
+    // fn(i) for i in [0, count), each in its own thread; false if any returned false
+    template<typename Fn>
+    bool ForEachParallel(size_t count, Fn fn) {
+        std::vector<std::future<bool>> tasks;
+        for (size_t i = 1; i < count; ++i) {
+            tasks.push_back(std::async(std::launch::async, fn, i));
+        }
+        bool ok = count == 0 || fn(0);
+        for (auto& task : tasks) {
+            ok = task.get() && ok;
+        }
+        return ok;
+    }
+
+}
+
+// appends the chunk with its header to out
+inline void CompressChunk(std::string_view raw, Method method, std::string& out) {
+    const size_t start = out.size();
+    out.append(StreamDetail::HEADER_SIZE, '\0');
+    switch (method) {
+        case Method::STORED:
+            out.append(raw);
+            break;
+        case Method::HUFFMAN:
+            HuffmanCompress(raw, out);
+            break;
+        case Method::LZ77:
+            Lz77Compress(raw, out);
+            break;
+        case Method::LZ77_HUFFMAN: {
+            std::string lz;
+            Lz77Compress(raw, lz);
+            StreamDetail::AppendUint32(lz.size(), out);
+            HuffmanCompress(lz, out);
+            break;
+        }
+    }
+    if (method != Method::STORED && out.size() - start - StreamDetail::HEADER_SIZE >= raw.size()) {
+        out.resize(start);
+        CompressChunk(raw, Method::STORED, out);
+        return;
+    }
+    std::string header;
+    header.push_back(static_cast<char>(method));
+    StreamDetail::AppendUint32(raw.size(), header);
+    StreamDetail::AppendUint32(out.size() - start - StreamDetail::HEADER_SIZE, header);
+    std::copy(header.begin(), header.end(), out.begin() + start);
+}
+
+// appends raw_size bytes to out; false if the chunk is corrupted
+inline bool DecompressChunk(Method method, std::string_view compressed, size_t raw_size, std::string& out) {
+    switch (method) {
+        case Method::STORED:
+            if (compressed.size() != raw_size) {
+                return false;
+            }
+            out.append(compressed);
+            return true;
+        case Method::HUFFMAN:
+            return HuffmanDecompress(compressed, raw_size, out);
+        case Method::LZ77:
+            return Lz77Decompress(compressed, raw_size, out);
+        case Method::LZ77_HUFFMAN: {
+            if (compressed.size() < 4) {
+                return false;
+            }
+            const uint32_t lz_size = StreamDetail::ReadUint32(compressed.data());
+            if (lz_size > StreamDetail::MAX_CHUNK_SIZE) {
+                return false;
+            }
+            std::string lz;
+            return HuffmanDecompress(compressed.substr(4), lz_size, lz) && Lz77Decompress(lz, raw_size, out);
+        }
+    }
+    return false;
+}
+
+// false on a read or write error
+inline bool CompressStream(int in_fd, int out_fd, const StreamOptions& options = {}) {
+    using namespace StreamDetail;
+    if (!WriteFull(out_fd, std::string_view(MAGIC, sizeof(MAGIC)))) {
+        return false;
+    }
+    const size_t chunk_size = std::clamp<size_t>(options.chunk_size, 1, MAX_CHUNK_SIZE);
+    const size_t batch_size = std::max<size_t>(1, options.thread_count);
+    std::vector<std::string> raw(batch_size);
+    std::vector<std::string> compressed(batch_size);
+    bool end = false;
+    while (!end) {
+        size_t count = 0;
+        for (; count < batch_size && !end; ++count) {
+            raw[count].resize(chunk_size);
+            const ssize_t got = ReadFull(in_fd, raw[count].data(), chunk_size);
+            if (got < 0) {
+                return false;
+            }
+            raw[count].resize(got);
+            end = static_cast<size_t>(got) < chunk_size;
+        }
+        if (raw[count - 1].empty()) {
+            --count;
+        }
+        ForEachParallel(count, [&](size_t i) {
+            compressed[i].clear();
+            CompressChunk(raw[i], options.method, compressed[i]);
+            return true;
+        });
+        for (size_t i = 0; i < count; ++i) {
+            if (!WriteFull(out_fd, compressed[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// false on a read or write error or if the stream is corrupted
+inline bool DecompressStream(int in_fd, int out_fd, size_t thread_count = std::max(1u, std::thread::hardware_concurrency())) {
+    using namespace StreamDetail;
+    char magic[sizeof(MAGIC)];
+    if (ReadFull(in_fd, magic, sizeof(magic)) != sizeof(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    struct Chunk {
+        Method method;
+        uint32_t raw_size;
+        std::string compressed;
+        std::string raw;
+    };
+    std::vector<Chunk> chunks(std::max<size_t>(1, thread_count));
+    bool end = false;
+    while (!end) {
+        size_t count = 0;
+        for (; count < chunks.size(); ++count) {
+            char header[HEADER_SIZE];
+            const ssize_t got = ReadFull(in_fd, header, HEADER_SIZE);
+            if (got == 0) {
+                end = true;
+                break;
+            }
+            if (got != static_cast<ssize_t>(HEADER_SIZE) || static_cast<uint8_t>(header[0]) > static_cast<uint8_t>(Method::LZ77_HUFFMAN)) {
+                return false;
+            }
+            Chunk& chunk = chunks[count];
+            chunk.method = static_cast<Method>(header[0]);
+            chunk.raw_size = ReadUint32(header + 1);
+            const uint32_t compressed_size = ReadUint32(header + 5);
+            if (chunk.raw_size > MAX_CHUNK_SIZE || compressed_size > MAX_CHUNK_SIZE) {
+                return false;
+            }
+            chunk.compressed.resize(compressed_size);
+            if (ReadFull(in_fd, chunk.compressed.data(), compressed_size) != static_cast<ssize_t>(compressed_size)) {
+                return false;
+            }
+        }
+        const bool ok = ForEachParallel(count, [&](size_t i) {
+            Chunk& chunk = chunks[i];
+            chunk.raw.clear();
+            return DecompressChunk(chunk.method, chunk.compressed, chunk.raw_size, chunk.raw);
+        });
+        if (!ok) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!WriteFull(out_fd, chunks[i].raw)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
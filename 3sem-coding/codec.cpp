@@ -0,0 +1,43 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "chunked_stream.h"
+
+using namespace std;
+
+// Compression of stdin to stdout by independent 1 MB chunks in several threads.
+// usage: ./codec c [huffman|lz77|lz77+huffman] < file > file.hlz
+//        ./codec d < file.hlz > file
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && strcmp(argv[1], "c") == 0) {
+        StreamOptions options;
+        const string method = argc >= 3 ? argv[2] : "lz77+huffman";
+        if (method == "huffman") {
+            options.method = Method::HUFFMAN;
+        } else if (method == "lz77") {
+            options.method = Method::LZ77;
+        } else if (method == "lz77+huffman") {
+            options.method = Method::LZ77_HUFFMAN;
+        } else {
+            cerr << "unknown method " << method << endl;
+            return 2;
+        }
+        if (!CompressStream(STDIN_FILENO, STDOUT_FILENO, options)) {
+            cerr << "read or write error" << endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "d") == 0) {
+        if (!DecompressStream(STDIN_FILENO, STDOUT_FILENO)) {
+            cerr << "corrupted stream or read/write error" << endl;
+            return 1;
+        }
+        return 0;
+    }
+    cerr << "usage: " << argv[0] << " c [huffman|lz77|lz77+huffman] < in > out" << endl
+         << "       " << argv[0] << " d < in > out" << endl;
+    return 2;
+}
@@ -0,0 +1,158 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "chunked_stream.h"
+#include "huffman.h"
+#include "lz77.h"
+
+using namespace std;
+
+// Speed (MB/s of raw data) and ratio on a synthetic query log: lines
+// "timestamp \t user id \t words of the query", words by a Zipf-like law.
+// Huffman: the table decoder against walking the code tree bit by bit.
+// Blocks are 1 MB, as the chunks of the stream; the stream is compressed through
+// memfd files in one thread and in all of them.
+// compile with -O2 -pthread
+// usage: ./codec_bench [megabytes]
+
+constexpr size_t BLOCK_SIZE = 1 << 20;
+
+string GenerateLog(mt19937& generator, size_t size) {
+    vector<string> words;
+    for (int i = 0; i < 50'000; ++i) {
+        string word;
+        const int length = uniform_int_distribution(2, 10)(generator);
+        for (int k = 0; k < length; ++k) {
+            word.push_back('a' + uniform_int_distribution(0, 25)(generator));
+        }
+        words.push_back(word);
+    }
+    // P(word i) ~ 1 / (i + 1)
+    vector<double> weights(words.size());
+    for (size_t i = 0; i < weights.size(); ++i) {
+        weights[i] = 1.0 / (i + 1);
+    }
+    discrete_distribution<size_t> word_distribution(weights.begin(), weights.end());
+
+    string log;
+    long long timestamp = 1'600'000'000'000;
+    while (log.size() < size) {
+        timestamp += uniform_int_distribution(0, 1000)(generator);
+        log += to_string(timestamp);
+        log += '\t';
+        log += to_string(uniform_int_distribution(1, 1'000'000)(generator));
+        log += '\t';
+        const int word_count = uniform_int_distribution(1, 6)(generator);
+        for (int k = 0; k < word_count; ++k) {
+            log += words[word_distribution(generator)];
+            log += k + 1 < word_count ? ' ' : '\n';
+        }
+    }
+    log.resize(size);
+    return log;
+}
+
+template<typename Function>
+void MeasureSpeed(const string& name, size_t bytes, Function function) {
+    const auto start = chrono::steady_clock::now();
+    function();
+    const chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+    cout << setw(45) << left << name << fixed << setprecision(1)
+         << bytes / seconds.count() / (1 << 20) << " MB/s" << endl;
+}
+
+void PrintRatio(const string& name, size_t raw, size_t compressed) {
+    cout << setw(45) << left << name << fixed << setprecision(3)
+         << static_cast<double>(compressed) / raw << " of the size" << endl;
+}
+
+// compress(block, out) for every block, returns the compressed blocks
+template<typename Compress>
+vector<string> CompressBlocks(const string& name, const string& data, Compress compress) {
+    vector<string> blocks;
+    size_t total = 0;
+    MeasureSpeed(name + " compress", data.size(), [&] {
+        for (size_t begin = 0; begin < data.size(); begin += BLOCK_SIZE) {
+            blocks.emplace_back();
+            compress(string_view(data).substr(begin, BLOCK_SIZE), blocks.back());
+        }
+    });
+    for (const string& block : blocks) {
+        total += block.size();
+    }
+    PrintRatio(name, data.size(), total);
+    return blocks;
+}
+
+template<typename Decompress>
+void DecompressBlocks(const string& name, const string& data, const vector<string>& blocks, Decompress decompress) {
+    string result;
+    result.reserve(data.size());
+    bool ok = true;
+    MeasureSpeed(name + " decompress", data.size(), [&] {
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            ok = decompress(blocks[i], min(BLOCK_SIZE, data.size() - i * BLOCK_SIZE), result) && ok;
+        }
+    });
+    if (!ok || result != data) {
+        cout << "WRONG RESULT" << endl;
+    }
+}
+
+void BenchStream(const string& data, Method method, size_t thread_count) {
+    const int input = memfd_create("input", 0);
+    const int compressed = memfd_create("compressed", 0);
+    const int output = memfd_create("output", 0);
+    StreamDetail::WriteFull(input, data);
+    lseek(input, 0, SEEK_SET);
+    StreamOptions options;
+    options.method = method;
+    options.thread_count = thread_count;
+    const string suffix = ", " + to_string(thread_count) + " threads";
+    MeasureSpeed("CompressStream" + suffix, data.size(), [&] {
+        CompressStream(input, compressed, options);
+    });
+    lseek(compressed, 0, SEEK_SET);
+    MeasureSpeed("DecompressStream" + suffix, data.size(), [&] {
+        DecompressStream(compressed, output, thread_count);
+    });
+    string result(data.size() + 1, '\0');
+    lseek(output, 0, SEEK_SET);
+    result.resize(StreamDetail::ReadFull(output, result.data(), result.size()));
+    if (result != data) {
+        cout << "WRONG RESULT" << endl;
+    }
+    close(input);
+    close(compressed);
+    close(output);
+}
+
+
+int main(int argc, char* argv[]) {
+    const size_t size = (argc > 1 ? stoul(argv[1]) : 64) << 20;
+    mt19937 generator;
+    const string data = GenerateLog(generator, size);
+
+    const auto huffman = CompressBlocks("Huffman", data, HuffmanCompress);
+    DecompressBlocks("Huffman, bit by bit", data, huffman, HuffmanDecompress<HuffmanTreeDecoder>);
+    DecompressBlocks("Huffman, table", data, huffman, HuffmanDecompress<HuffmanDecoder>);
+    cout << endl;
+
+    const auto lz = CompressBlocks("LZ77", data, [](string_view block, string& out) {
+        Lz77Compress(block, out);
+    });
+    DecompressBlocks("LZ77", data, lz, Lz77Decompress);
+    cout << endl;
+
+    const size_t threads = max(1u, thread::hardware_concurrency());
+    BenchStream(data, Method::LZ77_HUFFMAN, 1);
+    if (threads > 1) {
+        BenchStream(data, Method::LZ77_HUFFMAN, threads);
+    }
+}
@@ -0,0 +1,357 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Huffman coding of bytes.
+//
+// Code lengths are limited to MAX_CODE_LENGTH = 12 bits: then any code is
+// decoded by one lookup in a table of 2^12 entries (16 KB, fits in L1).
+// On real data the limit costs a fraction of a percent of the size.
+// Codes are canonical, so the compressed block stores only 256 lengths
+// (4 bits each, 128 bytes) and then the bits.
+//
+// Bits are written from the lowest bit of every byte (as in deflate), so the
+// decoder keeps a 64-bit buffer, refills it with one unaligned 8-byte load and
+// the next code is simply buffer & (2^12 - 1).
+//
+// HuffmanDecoder: an entry of the table holds all the codes that fit in the
+// 12 bits (up to 3 symbols) and their total length, so a lookup gives several
+// bytes at once; 4 lookups are done per refill.
+// HuffmanTreeDecoder is the decoder from the lecture: walk down the code tree
+// one bit at a time. It's the baseline for the benchmark.
+
+namespace HuffmanDetail {
+
+    constexpr int ALPHABET = 256;
+    constexpr int LENGTHS_SIZE = ALPHABET / 2;
+
+    inline uint32_t ReverseBits(uint32_t code, int length) {
+        uint32_t result = 0;
+        for (int i = 0; i < length; ++i) {
+            result = result << 1 | (code >> i & 1);
+        }
+        return result;
+    }
+
+    inline uint64_t Load64(const char* p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+}
+
+using CodeLengths = std::array<uint8_t, HuffmanDetail::ALPHABET>;
+
+constexpr int MAX_CODE_LENGTH = 12;
+
+// lengths of the Huffman codes of the bytes, 0 - the byte doesn't occur
+inline CodeLengths HuffmanCodeLengths(const std::array<uint64_t, HuffmanDetail::ALPHABET>& frequencies) {
+    using HuffmanDetail::ALPHABET;
+    CodeLengths lengths = {};
+    std::vector<int> symbols;
+    for (int c = 0; c < ALPHABET; ++c) {
+        if (frequencies[c] > 0) {
+            symbols.push_back(c);
+        }
+    }
+    if (symbols.size() <= 1) {
+        for (const int c : symbols) {
+            lengths[c] = 1;
+        }
+        return lengths;
+    }
+
+    // the usual Huffman tree; leaves are 0..ALPHABET-1, inner nodes go after them
+    std::vector<int> parent(2 * ALPHABET, -1);
+    using Item = std::pair<uint64_t, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<>> queue;
+    for (const int c : symbols) {
+        queue.emplace(frequencies[c], c);
+    }
+    int next_node = ALPHABET;
+    while (queue.size() > 1) {
+        const auto [first_frequency, first] = queue.top();
+        queue.pop();
+        const auto [second_frequency, second] = queue.top();
+        queue.pop();
+        parent[first] = parent[second] = next_node;
+        queue.emplace(first_frequency + second_frequency, next_node++);
+    }
+
+    // number of codes of every length, too long codes are cut to MAX_CODE_LENGTH
+    // and then the Kraft sum is fixed by making some shorter codes longer (as in miniz)
+    std::array<int, 64> count = {};
+    for (const int c : symbols) {
+        int depth = 0;
+        for (int v = c; parent[v] != -1; v = parent[v]) {
+            ++depth;
+        }
+        ++count[std::min(depth, MAX_CODE_LENGTH)];
+    }
+    uint32_t kraft = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; ++length) {
+        kraft += count[length] << (MAX_CODE_LENGTH - length);
+    }
+    for (; kraft > (1u << MAX_CODE_LENGTH); --kraft) {
+        --count[MAX_CODE_LENGTH];
+        for (int length = MAX_CODE_LENGTH - 1; length > 0; --length) {
+            if (count[length] > 0) {
+                --count[length];
+                count[length + 1] += 2;
+                break;
+            }
+        }
+    }
+
+    // the most frequent bytes get the shortest codes
+    std::stable_sort(symbols.begin(), symbols.end(), [&frequencies](int lhs, int rhs) {
+        return frequencies[lhs] > frequencies[rhs];
+    });
+    size_t i = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; ++length) {
+        for (int k = 0; k < count[length]; ++k) {
+            lengths[symbols[i++]] = length;
+        }
+    }
+    return lengths;
+}
+
+// canonical codes: shorter codes first, codes of one length in the order of bytes;
+// the first bit of a code is its highest bit
+inline std::array<uint16_t, HuffmanDetail::ALPHABET> CanonicalCodes(const CodeLengths& lengths) {
+    std::array<int, MAX_CODE_LENGTH + 2> next_code = {};
+    for (const uint8_t length : lengths) {
+        ++next_code[length + 1];
+    }
+    next_code[1] = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; ++length) {
+        next_code[length + 1] = (next_code[length] + next_code[length + 1]) << 1;
+    }
+    std::array<uint16_t, HuffmanDetail::ALPHABET> codes = {};
+    for (int c = 0; c < HuffmanDetail::ALPHABET; ++c) {
+        if (lengths[c] > 0) {
+            codes[c] = next_code[lengths[c]]++;
+        }
+    }
+    return codes;
+}
+
+// lengths are valid if no length is too long and the Kraft sum is at most 1
+inline bool ValidCodeLengths(const CodeLengths& lengths) {
+    uint32_t kraft = 0;
+    for (const uint8_t length : lengths) {
+        if (length > MAX_CODE_LENGTH) {
+            return false;
+        }
+        if (length > 0) {
+            kraft += 1u << (MAX_CODE_LENGTH - length);
+        }
+    }
+    return kraft <= (1u << MAX_CODE_LENGTH);
+}
+
+
+// appends 128 bytes of code lengths and the coded bits of data to out
+inline void HuffmanCompress(std::string_view data, std::string& out) {
+    using namespace HuffmanDetail;
+    std::array<uint64_t, ALPHABET> frequencies = {};
+    for (const char c : data) {
+        ++frequencies[static_cast<unsigned char>(c)];
+    }
+    const CodeLengths lengths = HuffmanCodeLengths(frequencies);
+    const auto codes = CanonicalCodes(lengths);
+    std::array<uint32_t, ALPHABET> reversed;
+    uint64_t bit_count = 0;
+    for (int c = 0; c < ALPHABET; ++c) {
+        reversed[c] = ReverseBits(codes[c], lengths[c]);
+        bit_count += frequencies[c] * lengths[c];
+    }
+
+    const size_t start = out.size();
+    const size_t size = LENGTHS_SIZE + (bit_count + 7) / 8;
+    out.resize(start + size + sizeof(uint32_t));
+    char* p = &out[start];
+    for (int c = 0; c < ALPHABET; c += 2) {
+        *p++ = lengths[c] | lengths[c + 1] << 4;
+    }
+    uint64_t buffer = 0;
+    int buffered = 0;
+    for (const char c : data) {
+        const unsigned char byte = c;
+        buffer |= static_cast<uint64_t>(reversed[byte]) << buffered;
+        buffered += lengths[byte];
+        if (buffered >= 32) {
+            const uint32_t low = buffer;
+            std::memcpy(p, &low, sizeof(low));
+            p += sizeof(low);
+            buffer >>= 32;
+            buffered -= 32;
+        }
+    }
+    for (; buffered > 0; buffered -= 8) {
+        *p++ = static_cast<char>(buffer);
+        buffer >>= 8;
+    }
+    out.resize(start + size);
+}
+
+// the code lengths from the start of a compressed block
+inline bool ReadCodeLengths(std::string_view compressed, CodeLengths& lengths) {
+    if (compressed.size() < HuffmanDetail::LENGTHS_SIZE) {
+        return false;
+    }
+    for (int i = 0; i < HuffmanDetail::LENGTHS_SIZE; ++i) {
+        const unsigned char byte = compressed[i];
+        lengths[2 * i] = byte & 15;
+        lengths[2 * i + 1] = byte >> 4;
+    }
+    return ValidCodeLengths(lengths);
+}
+
+
+class HuffmanDecoder {
+public:
+    static constexpr int TABLE_BITS = MAX_CODE_LENGTH;
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_BITS;
+    static constexpr uint64_t TABLE_MASK = TABLE_SIZE - 1;
+    // the decoder writes up to this many bytes after the end of the output
+    static constexpr size_t SLACK = 16;
+
+    explicit HuffmanDecoder(const CodeLengths& lengths) {
+        // one symbol for every TABLE_BITS bits; not assigned entries (incomplete
+        // code, only in corrupted data) decode as byte 0 of length 1
+        std::array<uint8_t, TABLE_SIZE> symbol = {};
+        std::array<uint8_t, TABLE_SIZE> length;
+        length.fill(1);
+        const auto codes = CanonicalCodes(lengths);
+        for (int c = 0; c < HuffmanDetail::ALPHABET; ++c) {
+            if (lengths[c] == 0) {
+                continue;
+            }
+            for (size_t i = HuffmanDetail::ReverseBits(codes[c], lengths[c]); i < TABLE_SIZE; i += size_t{1} << lengths[c]) {
+                symbol[i] = c;
+                length[i] = lengths[c];
+            }
+        }
+        // entry: bits 0-4 - total length, 5-6 - number of symbols, then the symbols by 8 bits
+        for (size_t i = 0; i < TABLE_SIZE; ++i) {
+            uint32_t entry = 0;
+            int total = 0;
+            int count = 0;
+            while (count < 3) {
+                const size_t rest = i >> total;
+                if (total + length[rest] > TABLE_BITS) {
+                    break;
+                }
+                entry |= static_cast<uint32_t>(symbol[rest]) << (8 + 8 * count);
+                total += length[rest];
+                ++count;
+            }
+            table_[i] = entry | total | count << 5;
+        }
+    }
+
+    // decodes raw_size bytes to out, out must have raw_size + SLACK bytes;
+    // the bits after the end of compressed are zeros
+    void Decode(std::string_view bits, size_t raw_size, char* out) const {
+        const char* in = bits.data();
+        const char* const in_end = in + bits.size();
+        char* const out_end = out + raw_size;
+        uint64_t buffer = 0;
+        int buffered = 0;
+        while (out < out_end) {
+            if (in_end - in >= 8) {
+                buffer |= HuffmanDetail::Load64(in) << buffered;
+                in += (63 - buffered) >> 3;
+                buffered |= 56;
+            } else {
+                for (; buffered <= 56; buffered += 8) {
+                    buffer |= static_cast<uint64_t>(in < in_end ? static_cast<unsigned char>(*in++) : 0) << buffered;
+                }
+            }
+            // 4 * 12 bits <= 56
+            for (int k = 0; k < 4; ++k) {
+                const uint32_t entry = table_[buffer & TABLE_MASK];
+                const uint32_t symbols = entry >> 8;
+                std::memcpy(out, &symbols, sizeof(symbols));
+                out += entry >> 5 & 3;
+                buffer >>= entry & 31;
+                buffered -= entry & 31;
+            }
+        }
+    }
+
+private:
+    std::array<uint32_t, TABLE_SIZE> table_;
+};
+
+
+class HuffmanTreeDecoder {
+public:
+    explicit HuffmanTreeDecoder(const CodeLengths& lengths)
+        : nodes_(1, {LEAF_ZERO, LEAF_ZERO})
+    {
+        const auto codes = CanonicalCodes(lengths);
+        for (int c = 0; c < HuffmanDetail::ALPHABET; ++c) {
+            int node = 0;
+            for (int i = lengths[c] - 1; i >= 0; --i) {
+                const int bit = codes[c] >> i & 1;
+                if (i == 0) {
+                    nodes_[node][bit] = -c - 1;
+                } else {
+                    if (nodes_[node][bit] < 0) {
+                        nodes_[node][bit] = nodes_.size();
+                        nodes_.push_back({LEAF_ZERO, LEAF_ZERO});
+                    }
+                    node = nodes_[node][bit];
+                }
+            }
+        }
+    }
+
+    void Decode(std::string_view bits, size_t raw_size, char* out) const {
+        size_t position = 0;
+        for (size_t i = 0; i < raw_size; ++i) {
+            int node = 0;
+            do {
+                const size_t byte = position >> 3;
+                const int bit = byte < bits.size() ? bits[byte] >> (position & 7) & 1 : 0;
+                ++position;
+                node = nodes_[node][bit];
+            } while (node >= 0);
+            out[i] = -node - 1;
+        }
+    }
+
+private:
+    // children of a node: an inner node index or -(byte + 1) for a leaf
+    static constexpr int LEAF_ZERO = -1;
+
+    std::vector<std::array<int, 2>> nodes_;
+};
+
+
+// decodes a block of HuffmanCompress, appends raw_size bytes to out; false if the block is corrupted
+template<typename Decoder = HuffmanDecoder>
+bool HuffmanDecompress(std::string_view compressed, size_t raw_size, std::string& out) {
+    CodeLengths lengths;
+    if (!ReadCodeLengths(compressed, lengths)) {
+        return false;
+    }
+    const Decoder decoder(lengths);
+    const size_t start = out.size();
+    out.resize(start + raw_size + HuffmanDecoder::SLACK);
+    decoder.Decode(compressed.substr(HuffmanDetail::LENGTHS_SIZE), raw_size, &out[start]);
+    out.resize(start + raw_size);
+    return true;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// LZ77 with a 64 KB window.
+//
+// Matches are found by hash chains: head[hash of 4 bytes] is the last position
+// with this hash, prev[position % WINDOW] is the previous one, at most
+// max_chain candidates are checked. Parsing is greedy.
+//
+// Format (byte aligned, as in LZ4): a sequence is a token byte (high 4 bits -
+// number of literals, low 4 bits - match length - MIN_MATCH, 15 means that
+// more length bytes follow: 255 ... 255 x), the literals, the offset (2 bytes,
+// little endian) and the rest of the match length. The last sequence has only
+// literals, it ends at the end of the block.
+//
+// The decoder copies matches by 8 bytes if the offset is at least 8 (the copy
+// may write past the match, so the output has SLACK bytes more) and checks
+// every length and offset, a corrupted block gives false, not a crash.
+
+namespace Lz77Detail {
+
+    constexpr size_t MIN_MATCH = 4;
+    constexpr size_t WINDOW = 1 << 16;
+    constexpr size_t MAX_OFFSET = WINDOW - 1;
+    constexpr int HASH_BITS = 16;
+    constexpr uint32_t NONE = UINT32_MAX;
+
+    inline uint32_t Load32(const char* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t Load64(const char* p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t Hash(const char* p) {
+        return Load32(p) * 2654435761u >> (32 - HASH_BITS);
+    }
+
+    // length of the common prefix of a and b, at most limit
+    inline size_t MatchLength(const char* a, const char* b, size_t limit) {
+        size_t length = 0;
+        while (length + 8 <= limit) {
+            const uint64_t diff = Load64(a + length) ^ Load64(b + length);
+            if (diff != 0) {
+                return length + (__builtin_ctzll(diff) >> 3);
+            }
+            length += 8;
+        }
+        while (length < limit && a[length] == b[length]) {
+            ++length;
+        }
+        return length;
+    }
+
+    inline void WriteLength(size_t length, std::string& out) {
+        for (; length >= 255; length -= 255) {
+            out.push_back(static_cast<char>(255));
+        }
+        out.push_back(static_cast<char>(length));
+    }
+
+    inline bool ReadLength(const char*& p, const char* end, size_t& length) {
+        unsigned char byte;
+        do {
+            if (p == end) {
+                return false;
+            }
+            byte = *p++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    inline void WriteSequence(std::string_view literals, size_t offset, size_t match_length, std::string& out) {
+        const bool last = match_length == 0;
+        const size_t extra = last ? 0 : match_length - MIN_MATCH;
+        out.push_back(static_cast<char>(std::min<size_t>(literals.size(), 15) << 4 | std::min<size_t>(extra, 15)));
+        if (literals.size() >= 15) {
+            WriteLength(literals.size() - 15, out);
+        }
+        out.append(literals);
+        if (last) {
+            return;
+        }
+        out.push_back(static_cast<char>(offset));
+        out.push_back(static_cast<char>(offset >> 8));
+        if (extra >= 15) {
+            WriteLength(extra - 15, out);
+        }
+    }
+
+}
+
+constexpr int LZ77_DEFAULT_CHAIN = 16;
+
+// appends the compressed data to out
+inline void Lz77Compress(std::string_view data, std::string& out, int max_chain = LZ77_DEFAULT_CHAIN) {
+    using namespace Lz77Detail;
+    std::vector<uint32_t> head(size_t{1} << HASH_BITS, NONE);
+    std::vector<uint32_t> prev(WINDOW);
+    const char* const base = data.data();
+    const size_t size = data.size();
+    auto insert = [&](size_t position) {
+        const uint32_t hash = Hash(base + position);
+        prev[position % WINDOW] = head[hash];
+        head[hash] = position;
+    };
+
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MIN_MATCH <= size) {
+        size_t best_length = 0;
+        size_t best_offset = 0;
+        uint32_t candidate = head[Hash(base + i)];
+        for (int chain = 0; chain < max_chain && candidate != NONE && i - candidate <= MAX_OFFSET; ++chain) {
+            if (best_length == size - i) {
+                break;
+            }
+            // a longer match must also match the byte after the best one
+            if (base[candidate + best_length] == base[i + best_length]) {
+                const size_t length = MatchLength(base + candidate, base + i, size - i);
+                if (length > best_length) {
+                    best_length = length;
+                    best_offset = i - candidate;
+                }
+            }
+            candidate = prev[candidate % WINDOW];
+        }
+        if (best_length < MIN_MATCH) {
+            insert(i);
+            ++i;
+            continue;
+        }
+        WriteSequence(data.substr(anchor, i - anchor), best_offset, best_length, out);
+        const size_t end = i + best_length;
+        for (; i < end && i + MIN_MATCH <= size; ++i) {
+            insert(i);
+        }
+        i = anchor = end;
+    }
+    WriteSequence(data.substr(anchor), 0, 0, out);
+}
+
+// appends raw_size bytes to out; false if the block is corrupted
+inline bool Lz77Decompress(std::string_view compressed, size_t raw_size, std::string& out) {
+    using namespace Lz77Detail;
+    constexpr size_t SLACK = 8;
+    const size_t start = out.size();
+    out.resize(start + raw_size + SLACK);
+    char* const first = &out[start];
+    char* const last = first + raw_size;
+    char* o = first;
+    const char* p = compressed.data();
+    const char* const end = p + compressed.size();
+    while (true) {
+        if (p == end) {
+            return false;
+        }
+        const unsigned char token = *p++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !ReadLength(p, end, literals)) {
+            return false;
+        }
+        if (literals > static_cast<size_t>(end - p) || literals > static_cast<size_t>(last - o)) {
+            return false;
+        }
+        std::memcpy(o, p, literals);
+        o += literals;
+        p += literals;
+        if (p == end) {
+            break;
+        }
+
+        if (end - p < 2) {
+            return false;
+        }
+        const size_t offset = static_cast<unsigned char>(p[0]) | static_cast<unsigned char>(p[1]) << 8;
+        p += 2;
+        size_t length = (token & 15) + MIN_MATCH;
+        if ((token & 15) == 15 && !ReadLength(p, end, length)) {
+            return false;
+        }
+        if (offset == 0 || offset > static_cast<size_t>(o - first) || length > static_cast<size_t>(last - o)) {
+            return false;
+        }
+        const char* match = o - offset;
+        if (offset >= 8) {
+            for (size_t copied = 0; copied < length; copied += 8) {
+                std::memcpy(o + copied, match + copied, 8);
+            }
+        } else {
+            for (size_t k = 0; k < length; ++k) {
+                o[k] = match[k];
+            }
+        }
+        o += length;
+    }
+    if (o != last) {
+        return false;
+    }
+    out.resize(start + raw_size);
+    return true;
+}
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+#ifdef __AVX2__
+  #include <immintrin.h>
+#endif
+
+// SECDED code (72, 64): an extended Hamming code, for every 8 bytes of data one
+// check byte; any single bit error in the 72 bits is corrected, any double one
+// is detected.
+//
+// The code is systematic: the data stays as is, the check bytes are stored
+// separately (1/8 of the size). Data bit i has a 7-bit column H[i], all columns
+// are different and have at least two bits set (columns with one bit are the
+// check bits themselves). Check bits c = XOR of H[i] over the set data bits,
+// bit 7 of the check byte is the parity of all 71 other bits.
+//
+// Decoding: s = stored c ^ computed c (syndrome), p = parity of all 72 bits.
+//   s = 0, p = 0 - no errors;
+//   p = 1       - one error: in the data bit with H[i] = s, in check bit j if
+//                 s = 2^j, in the parity bit if s = 0;
+//   s != 0, p = 0 - two errors, can't be corrected.
+// Computed check bytes are compared with the stored ones 8 words at a time, the
+// slow path is only for words with errors.
+//
+// The check byte is computed by a table (SecdedTable: 8 lookups of 256-entry
+// tables, one per byte of the word, 2 KB), by popcount (SecdedPopcount: parity
+// of the word & mask of every check bit, popcnt needs -mpopcnt or -march=native)
+// or by AVX2 for 4 words at once (SecdedSimd, see below).
+// Buffers are split between threads, words are independent.
+
+namespace SecdedDetail {
+
+    constexpr int DATA_BITS = 64;
+
+    // high 4 bits of the columns of byte k, all with at least two bits set
+    constexpr uint8_t BYTE_COLUMNS[8] = {3 << 3, 5 << 3, 6 << 3, 7 << 3, 9 << 3, 10 << 3, 11 << 3, 12 << 3};
+
+    // the column of bit b of byte k is b | BYTE_COLUMNS[k]
+    constexpr std::array<uint8_t, DATA_BITS> Columns() {
+        std::array<uint8_t, DATA_BITS> columns = {};
+        for (int i = 0; i < DATA_BITS; ++i) {
+            columns[i] = (i % 8) | BYTE_COLUMNS[i / 8];
+        }
+        return columns;
+    }
+
+    constexpr std::array<uint8_t, DATA_BITS> COLUMNS = Columns();
+
+    // MASKS[j] - the data bits that take part in check bit j
+    constexpr std::array<uint64_t, 7> Masks() {
+        std::array<uint64_t, 7> masks = {};
+        for (int i = 0; i < DATA_BITS; ++i) {
+            for (int j = 0; j < 7; ++j) {
+                if (COLUMNS[i] >> j & 1) {
+                    masks[j] |= uint64_t{1} << i;
+                }
+            }
+        }
+        return masks;
+    }
+
+    constexpr std::array<uint64_t, 7> MASKS = Masks();
+
+    // TABLE[k][b] - check bits of byte b at position k, bit 7 - parity of b
+    constexpr std::array<std::array<uint8_t, 256>, 8> Table() {
+        std::array<std::array<uint8_t, 256>, 8> table = {};
+        for (int k = 0; k < 8; ++k) {
+            for (int b = 0; b < 256; ++b) {
+                uint8_t value = 0;
+                for (int bit = 0; bit < 8; ++bit) {
+                    if (b >> bit & 1) {
+                        value ^= COLUMNS[8 * k + bit] | 0x80;
+                    }
+                }
+                table[k][b] = value;
+            }
+        }
+        return table;
+    }
+
+    constexpr std::array<std::array<uint8_t, 256>, 8> TABLE = Table();
+
+    // syndrome -> data bit, -1 if no data bit has this column
+    constexpr std::array<int8_t, 128> Positions() {
+        std::array<int8_t, 128> positions = {};
+        for (auto& position : positions) {
+            position = -1;
+        }
+        for (int i = 0; i < DATA_BITS; ++i) {
+            positions[COLUMNS[i]] = i;
+        }
+        return positions;
+    }
+
+    constexpr std::array<int8_t, 128> POSITIONS = Positions();
+
+    // BYTE_PARITY_COLUMNS[m] - XOR of BYTE_COLUMNS[k] over the bits k set in m
+    constexpr std::array<uint8_t, 256> ByteParityColumns() {
+        std::array<uint8_t, 256> columns = {};
+        for (int m = 0; m < 256; ++m) {
+            for (int k = 0; k < 8; ++k) {
+                if (m >> k & 1) {
+                    columns[m] ^= BYTE_COLUMNS[k];
+                }
+            }
+        }
+        return columns;
+    }
+
+    constexpr std::array<uint8_t, 256> BYTE_PARITY_COLUMNS = ByteParityColumns();
+
+    // for a nibble at bits [shift, shift + 4) of a byte: XOR of the indices of its
+    // set bits in the byte (3 bits) and its parity (bit 3)
+    constexpr std::array<uint8_t, 16> NibbleTable(int shift) {
+        std::array<uint8_t, 16> table = {};
+        for (int n = 0; n < 16; ++n) {
+            for (int bit = 0; bit < 4; ++bit) {
+                if (n >> bit & 1) {
+                    table[n] ^= (bit + shift) | 8;
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr std::array<uint8_t, 16> LOW_NIBBLES = NibbleTable(0);
+    constexpr std::array<uint8_t, 16> HIGH_NIBBLES = NibbleTable(4);
+
+    // x: bits 0-6 - check bits, bit 7 - parity of the data
+    inline uint8_t FinishCheckByte(uint8_t x) {
+        return (x & 0x7F) | __builtin_parity(x) << 7;
+    }
+
+    // the last word of the buffer may be shorter, it is padded with zeros
+    inline uint64_t LoadWord(const char* data, size_t size, size_t word) {
+        uint64_t value = 0;
+        if (8 * word + 8 <= size) {
+            std::memcpy(&value, data + 8 * word, 8);
+        } else {
+            std::memcpy(&value, data + 8 * word, size - 8 * word);
+        }
+        return value;
+    }
+
+    inline void StoreWord(char* data, size_t size, size_t word, uint64_t value) {
+        std::memcpy(data + 8 * word, &value, std::min<size_t>(8, size - 8 * word));
+    }
+
+    // fn(thread, first, last) for ranges of words, at least MIN_WORDS_PER_THREAD words in a range
+    template<typename Fn>
+    void ForEachWordRange(size_t word_count, size_t thread_count, Fn fn) {
+        constexpr size_t MIN_WORDS_PER_THREAD = 1 << 17;
+        thread_count = std::max<size_t>(1, std::min(thread_count, word_count / MIN_WORDS_PER_THREAD));
+        std::vector<std::future<void>> threads;
+        for (size_t thread = 1; thread < thread_count; ++thread) {
+            threads.push_back(std::async(std::launch::async, fn, thread,
+                                         word_count * thread / thread_count, word_count * (thread + 1) / thread_count));
+        }
+        fn(0, 0, word_count / thread_count);
+        for (auto& thread : threads) {
+            thread.get();
+        }
+    }
+
+    inline size_t DefaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+}
+
+namespace SecdedDetail {
+
+    // check bytes of word_count whole words one by one
+    template<typename Code>
+    void CheckBytesByWord(const char* data, size_t word_count, uint8_t* checks) {
+        for (size_t word = 0; word < word_count; ++word) {
+            uint64_t value;
+            std::memcpy(&value, data + 8 * word, sizeof(value));
+            checks[word] = Code::CheckByte(value);
+        }
+    }
+
+}
+
+struct SecdedTable {
+    static uint8_t CheckByte(uint64_t word) {
+        const auto& table = SecdedDetail::TABLE;
+        uint8_t x = 0;
+        for (int k = 0; k < 8; ++k) {
+            x ^= table[k][word >> (8 * k) & 0xFF];
+        }
+        return SecdedDetail::FinishCheckByte(x);
+    }
+
+    static void CheckBytes(const char* data, size_t word_count, uint8_t* checks) {
+        SecdedDetail::CheckBytesByWord<SecdedTable>(data, word_count, checks);
+    }
+};
+
+struct SecdedPopcount {
+    static uint8_t CheckByte(uint64_t word) {
+        uint8_t x = __builtin_parityll(word) << 7;
+        for (int j = 0; j < 7; ++j) {
+            x |= __builtin_parityll(word & SecdedDetail::MASKS[j]) << j;
+        }
+        return SecdedDetail::FinishCheckByte(x);
+    }
+
+    static void CheckBytes(const char* data, size_t word_count, uint8_t* checks) {
+        SecdedDetail::CheckBytesByWord<SecdedPopcount>(data, word_count, checks);
+    }
+};
+
+// 4 words per AVX2 register. The columns are chosen so that the check bits of
+// a byte are (XOR of the indices of its set bits) | (its parity ? BYTE_COLUMNS[k] : 0).
+// The first part and the parity are the same function for every byte, so they
+// are two nibble lookups (pshufb) for all 32 bytes at once, then XOR of the 8
+// bytes of every word; the parities of the bytes of a word are gathered by
+// movemask into one byte m, and the second part is one lookup by m.
+struct SecdedSimd {
+    static uint8_t CheckByte(uint64_t word) {
+        return SecdedTable::CheckByte(word);
+    }
+
+    static void CheckBytes(const char* data, size_t word_count, uint8_t* checks) {
+        size_t word = 0;
+#ifdef __AVX2__
+        using namespace SecdedDetail;
+        const __m256i low_table = Broadcast(LOW_NIBBLES);
+        const __m256i high_table = Broadcast(HIGH_NIBBLES);
+        const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+        for (; word + 4 <= word_count; word += 4) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 8 * word));
+            __m256i x = _mm256_xor_si256(
+                _mm256_shuffle_epi8(low_table, _mm256_and_si256(bytes, nibble_mask)),
+                _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble_mask)));
+            // bit 3 (parity of a byte) to the sign bit
+            const uint32_t odd_bytes = _mm256_movemask_epi8(_mm256_slli_epi16(x, 4));
+            x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 32));
+            x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 16));
+            x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 8));
+            alignas(32) uint64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), x);
+            for (int k = 0; k < 4; ++k) {
+                // bits 0-2 of the lane - check bits 0-2, bit 3 - parity of the data
+                const uint8_t odd = odd_bytes >> (8 * k);
+                const uint8_t low = lanes[k];
+                checks[word + k] = FinishCheckByte((low & 7) | BYTE_PARITY_COLUMNS[odd] | (low & 8) << 4);
+            }
+        }
+#endif
+        SecdedDetail::CheckBytesByWord<SecdedSimd>(data + 8 * word, word_count - word, checks + word);
+    }
+
+private:
+#ifdef __AVX2__
+    static __m256i Broadcast(const std::array<uint8_t, 16>& table) {
+        const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data()));
+        return _mm256_broadcastsi128_si256(half);
+    }
+#endif
+};
+
+enum class SecdedStatus {
+    OK,
+    CORRECTED,
+    UNCORRECTABLE,
+};
+
+// fixes word and check byte if there is one error
+template<typename Code = SecdedTable>
+SecdedStatus SecdedCorrect(uint64_t& word, uint8_t& check) {
+    const uint8_t computed = Code::CheckByte(word);
+    const uint8_t syndrome = (computed ^ check) & 0x7F;
+    // parity of data + stored check bits + stored parity bit
+    const bool odd = (__builtin_parityll(word) ^ __builtin_parity(check)) != 0;
+    if (syndrome == 0 && !odd) {
+        return SecdedStatus::OK;
+    }
+    if (!odd) {
+        return SecdedStatus::UNCORRECTABLE;
+    }
+    if (syndrome == 0 || (syndrome & (syndrome - 1)) == 0) {
+        check = computed;
+        return SecdedStatus::CORRECTED;
+    }
+    const int position = SecdedDetail::POSITIONS[syndrome];
+    if (position < 0) {
+        return SecdedStatus::UNCORRECTABLE;
+    }
+    word ^= uint64_t{1} << position;
+    return SecdedStatus::CORRECTED;
+}
+
+inline size_t SecdedCheckSize(size_t data_size) {
+    return (data_size + 7) / 8;
+}
+
+// checks must have SecdedCheckSize(size) bytes; the last word is padded with zeros
+template<typename Code = SecdedTable>
+void SecdedEncode(const char* data, size_t size, uint8_t* checks,
+                  size_t thread_count = SecdedDetail::DefaultThreadCount()) {
+    const size_t whole_words = size / 8;
+    SecdedDetail::ForEachWordRange(whole_words, thread_count, [=](size_t, size_t first, size_t last) {
+        Code::CheckBytes(data + 8 * first, last - first, checks + first);
+    });
+    if (whole_words < SecdedCheckSize(size)) {
+        checks[whole_words] = Code::CheckByte(SecdedDetail::LoadWord(data, size, whole_words));
+    }
+}
+
+struct SecdedReport {
+    size_t corrected = 0;
+    size_t uncorrectable = 0;
+};
+
+namespace SecdedDetail {
+
+    template<typename Code>
+    void Fix(char* data, size_t size, uint8_t* checks, size_t word, SecdedReport& report) {
+        uint64_t value = LoadWord(data, size, word);
+        switch (SecdedCorrect<Code>(value, checks[word])) {
+            case SecdedStatus::OK:
+                break;
+            case SecdedStatus::CORRECTED:
+                StoreWord(data, size, word, value);
+                ++report.corrected;
+                break;
+            case SecdedStatus::UNCORRECTABLE:
+                ++report.uncorrectable;
+                break;
+        }
+    }
+
+}
+
+// checks the data, fixes single errors in place (in the data and in the check bytes)
+template<typename Code = SecdedTable>
+SecdedReport SecdedVerify(char* data, size_t size, uint8_t* checks,
+                          size_t thread_count = SecdedDetail::DefaultThreadCount()) {
+    std::vector<SecdedReport> reports(std::max<size_t>(1, thread_count));
+    SecdedDetail::ForEachWordRange(SecdedCheckSize(size), thread_count, [&](size_t thread, size_t first, size_t last) {
+        SecdedReport& report = reports[thread];
+        // check bytes are computed for a block of words and compared with the
+        // stored ones 8 at a time, only words with errors are looked at one by one
+        constexpr size_t BLOCK_WORDS = 512;
+        uint8_t computed[BLOCK_WORDS];
+        const size_t whole_last = std::min(last, size / 8);
+        size_t word = first;
+        for (; word + BLOCK_WORDS <= whole_last; word += BLOCK_WORDS) {
+            Code::CheckBytes(data + 8 * word, BLOCK_WORDS, computed);
+            for (size_t k = 0; k < BLOCK_WORDS; k += 8) {
+                if (std::memcmp(computed + k, checks + word + k, 8) != 0) {
+                    for (size_t i = k; i < k + 8; ++i) {
+                        SecdedDetail::Fix<Code>(data, size, checks, word + i, report);
+                    }
+                }
+            }
+        }
+        for (; word < last; ++word) {
+            SecdedDetail::Fix<Code>(data, size, checks, word, report);
+        }
+    });
+    SecdedReport total;
+    for (const SecdedReport& report : reports) {
+        total.corrected += report.corrected;
+        total.uncorrectable += report.uncorrectable;
+    }
+    return total;
+}
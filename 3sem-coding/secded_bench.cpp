@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "secded.h"
+
+using namespace std;
+
+// Bandwidth (GB/s of data) of SECDED encoding and verification against memcpy
+// of the same buffer, table against popcount and AVX2, one thread against all of them.
+// compile with -O2 -march=native -pthread (popcount needs -mpopcnt)
+// usage: ./secded_bench [megabytes]
+
+template<typename Function>
+double MeasureBandwidth(const string& name, size_t bytes, Function function) {
+    const auto start = chrono::steady_clock::now();
+    function();
+    const chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+    const double bandwidth = bytes / seconds.count() / (1 << 30);
+    cout << setw(40) << left << name << fixed << setprecision(2) << bandwidth << " GB/s" << endl;
+    return bandwidth;
+}
+
+template<typename Code>
+void Bench(const string& name, string& data, const vector<uint8_t>& expected, size_t thread_count) {
+    const string suffix = ", " + to_string(thread_count) + " threads";
+    vector<uint8_t> checks(SecdedCheckSize(data.size()));
+    MeasureBandwidth(name + " encode" + suffix, data.size(), [&] {
+        SecdedEncode<Code>(data.data(), data.size(), checks.data(), thread_count);
+    });
+    if (checks != expected) {
+        cout << "WRONG RESULT" << endl;
+    }
+    SecdedReport report;
+    MeasureBandwidth(name + " verify" + suffix, data.size(), [&] {
+        report = SecdedVerify<Code>(data.data(), data.size(), checks.data(), thread_count);
+    });
+    if (report.corrected != 0 || report.uncorrectable != 0) {
+        cout << "WRONG RESULT" << endl;
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    const size_t size = (argc > 1 ? stoul(argv[1]) : 256) << 20;
+    mt19937_64 generator;
+    string data(size, '\0');
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        const uint64_t value = generator();
+        memcpy(&data[i], &value, sizeof(value));
+    }
+
+    string copy(size, '\0');
+    MeasureBandwidth("memcpy", size, [&] {
+        memcpy(copy.data(), data.data(), size);
+    });
+    vector<uint8_t> expected(SecdedCheckSize(size));
+    SecdedEncode(data.data(), size, expected.data(), 1);
+
+    const size_t threads = SecdedDetail::DefaultThreadCount();
+    for (const size_t thread_count : {size_t{1}, threads}) {
+        Bench<SecdedTable>("table", data, expected, thread_count);
+        Bench<SecdedPopcount>("popcount", data, expected, thread_count);
+        Bench<SecdedSimd>("simd", data, expected, thread_count);
+        if (threads == 1) {
+            break;
+        }
+    }
+
+    // one flipped bit in every 4096th word, all of them are fixed
+    vector<uint8_t> checks = expected;
+    size_t flipped = 0;
+    for (size_t word = 0; word < checks.size(); word += 4096, ++flipped) {
+        data[8 * word + generator() % 8] ^= 1 << (generator() % 8);
+    }
+    SecdedReport report;
+    MeasureBandwidth("verify with " + to_string(flipped) + " errors", size, [&] {
+        report = SecdedVerify<SecdedSimd>(data.data(), size, checks.data());
+    });
+    if (report.corrected != flipped || report.uncorrectable != 0 || data != copy) {
+        cout << "WRONG RESULT" << endl;
+    }
+}
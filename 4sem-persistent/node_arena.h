@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Storage for nodes of persistent structures.
+//
+// Nodes are never moved: they live in chunks of CHUNK_SIZE nodes and are
+// referenced by 32-bit index instead of a pointer (index = chunk * CHUNK_SIZE + offset).
+// So a node like {uint32_t prev; int val;} takes 8 bytes instead of 16,
+// nodes created one after another lie next to each other in memory,
+// and all of them are freed at once with the arena.
+// A node given back with deallocate is reused by the next allocate.
+template<typename Node, int CHUNK_BITS = 16>
+class NodeArena {
+public:
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+
+    NodeArena() = default;
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    uint32_t allocate(const Node& node) {
+        uint32_t index;
+        if (!free_list.empty()) {
+            index = free_list.back();
+            free_list.pop_back();
+        } else {
+            if (size == chunks.size() * CHUNK_SIZE) {
+                chunks.emplace_back(new Node[CHUNK_SIZE]);
+            }
+            index = size++;
+        }
+        (*this)[index] = node;
+        return index;
+    }
+
+    void deallocate(uint32_t index) {
+        free_list.push_back(index);
+    }
+
+    Node& operator[](uint32_t index) {
+        return chunks[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+    }
+
+    const Node& operator[](uint32_t index) const {
+        return chunks[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+    }
+
+    // number of allocated and not deallocated nodes
+    uint32_t count() const {
+        return size - free_list.size();
+    }
+
+    size_t memory_usage() const {
+        return chunks.size() * CHUNK_SIZE * sizeof(Node) + free_list.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    std::vector<std::unique_ptr<Node[]>> chunks;
+    uint32_t size = 0;
+    std::vector<uint32_t> free_list;
+};
+
+
+// The same for many threads: allocate and operator[] may be called concurrently.
+// The index comes from an atomic counter; chunks are never moved or reallocated
+// (the table of chunks has a fixed size), so a reader of an old node never
+// waits for a writer and is never invalidated by it.
+//
+// A node written by allocate is visible to another thread only if its index
+// was passed there with a happens-before relation (e.g. a release store
+// of the index and an acquire load of it).
+// Deallocated nodes go to a free list under a mutex: it's touched only if
+// something was deallocated, structures that never deallocate don't lock.
+template<typename Node, int CHUNK_BITS = 16>
+class ConcurrentNodeArena {
+public:
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static constexpr uint32_t MAX_CHUNKS = 1u << (32 - CHUNK_BITS);
+
+    ConcurrentNodeArena()
+        : chunks(new std::atomic<Node*>[MAX_CHUNKS])
+    {
+        for (uint32_t i = 0; i != MAX_CHUNKS; ++i) {
+            chunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentNodeArena(const ConcurrentNodeArena&) = delete;
+    ConcurrentNodeArena& operator=(const ConcurrentNodeArena&) = delete;
+
+    ~ConcurrentNodeArena() {
+        for (uint32_t i = 0; i != MAX_CHUNKS; ++i) {
+            delete[] chunks[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // index of a new node that is not initialized yet
+    uint32_t allocate() {
+        if (free_count.load(std::memory_order_relaxed) != 0) {
+            std::lock_guard guard(free_mutex);
+            if (!free_list.empty()) {
+                const uint32_t index = free_list.back();
+                free_list.pop_back();
+                free_count.store(free_list.size(), std::memory_order_relaxed);
+                return index;
+            }
+        }
+        const uint32_t index = size.fetch_add(1, std::memory_order_relaxed);
+        chunk(index >> CHUNK_BITS);
+        return index;
+    }
+
+    uint32_t allocate(const Node& node) {
+        const uint32_t index = allocate();
+        (*this)[index] = node;
+        return index;
+    }
+
+    Node& operator[](uint32_t index) {
+        return chunks[index >> CHUNK_BITS].load(std::memory_order_acquire)[index & (CHUNK_SIZE - 1)];
+    }
+
+    const Node& operator[](uint32_t index) const {
+        return chunks[index >> CHUNK_BITS].load(std::memory_order_acquire)[index & (CHUNK_SIZE - 1)];
+    }
+
+    void deallocate(uint32_t index) {
+        std::lock_guard guard(free_mutex);
+        free_list.push_back(index);
+        free_count.store(free_list.size(), std::memory_order_relaxed);
+    }
+
+    // includes the nodes that are being allocated right now
+    uint32_t count() const {
+        return size.load(std::memory_order_relaxed) - free_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    Node* chunk(uint32_t number) {
+        Node* result = chunks[number].load(std::memory_order_acquire);
+        if (result != nullptr) {
+            return result;
+        }
+        // several threads may come here at once, only one chunk wins
+        Node* created = new Node[CHUNK_SIZE];
+        if (chunks[number].compare_exchange_strong(result, created, std::memory_order_acq_rel)) {
+            return created;
+        }
+        delete[] created;
+        return result;
+    }
+
+    std::unique_ptr<std::atomic<Node*>[]> chunks;
+    std::atomic<uint32_t> size = 0;
+    std::mutex free_mutex;
+    std::vector<uint32_t> free_list;
+    std::atomic<uint32_t> free_count = 0;
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "node_arena.h"
+
+// Persistent array and deque on a path-copying trie.
+//
+// The index is split into 4-bit digits, a node has 16 children (16 * 4 bytes,
+// one cache line). set copies the nodes on the path from the root to the leaf
+// (depth of them), all the other nodes are shared with the old version,
+// so get and set are O(log16 n).
+
+class PersistentTrie {
+public:
+    static constexpr int BITS = 4;
+    static constexpr uint32_t FANOUT = 1u << BITS;
+    static constexpr int MAX_DEPTH = 32 / BITS;
+
+    // trie for indices [0, 16^depth), all values are equal to value.
+    // Such a trie needs only one node per level: all children are the same node
+    PersistentTrie(int depth, int value)
+        : depth(depth)
+    {
+        Leaf leaf;
+        for (int& v : leaf.values) {
+            v = value;
+        }
+        uint32_t node = leaves.allocate(leaf);
+        for (int level = 1; level < depth; ++level) {
+            Inner inner;
+            for (uint32_t& child : inner.children) {
+                child = node;
+            }
+            node = inners.allocate(inner);
+        }
+        empty_root = node;
+    }
+
+    uint32_t initial_root() const {
+        return empty_root;
+    }
+
+    int get(uint32_t root, uint32_t index) const {
+        uint32_t node = root;
+        for (int level = depth - 1; level > 0; --level) {
+            node = inners[node].children[digit(index, level)];
+        }
+        return leaves[node].values[digit(index, 0)];
+    }
+
+    // returns the root of the new version
+    uint32_t set(uint32_t root, uint32_t index, int value) {
+        uint32_t path[MAX_DEPTH];
+        uint32_t node = root;
+        for (int level = depth - 1; level > 0; --level) {
+            path[level] = node;
+            node = inners[node].children[digit(index, level)];
+        }
+
+        Leaf leaf = leaves[node];
+        leaf.values[digit(index, 0)] = value;
+        uint32_t copy = leaves.allocate(leaf);
+        for (int level = 1; level < depth; ++level) {
+            Inner inner = inners[path[level]];
+            inner.children[digit(index, level)] = copy;
+            copy = inners.allocate(inner);
+        }
+        return copy;
+    }
+
+    size_t memory_usage() const {
+        return inners.memory_usage() + leaves.memory_usage();
+    }
+
+private:
+    struct Inner {
+        uint32_t children[FANOUT];
+    };
+
+    struct Leaf {
+        int values[FANOUT];
+    };
+
+    static uint32_t digit(uint32_t index, int level) {
+        return (index >> (BITS * level)) & (FANOUT - 1);
+    }
+
+    const int depth;
+    uint32_t empty_root;
+    NodeArena<Inner> inners;
+    NodeArena<Leaf> leaves;
+};
+
+
+// Array of fixed size, version 0 is filled with value.
+class PArray {
+private:
+    PersistentTrie trie;
+    std::vector<uint32_t> versions;
+    const size_t length;
+
+    static int depth_for(size_t size) {
+        int depth = 1;
+        while (depth < PersistentTrie::MAX_DEPTH && size > 0
+               && ((size - 1) >> (PersistentTrie::BITS * depth)) != 0) {
+            ++depth;
+        }
+        return depth;
+    }
+
+public:
+    explicit PArray(size_t size, int value = 0)
+        : trie(depth_for(size), value)
+        , length(size)
+    {
+        versions.push_back(trie.initial_root());
+    }
+
+    int get(int version, size_t index) const {
+        return trie.get(versions[version], index);
+    }
+
+    int set(int version, size_t index, int val) {
+        versions.push_back(trie.set(versions[version], index, val));
+        return versions.size() - 1;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    int version_count() const {
+        return versions.size();
+    }
+
+    size_t memory_usage() const {
+        return trie.memory_usage() + versions.capacity() * sizeof(uint32_t);
+    }
+};
+
+
+// Deque with random access, every operation copies 8 nodes: the trie always has
+// the full depth MAX_DEPTH = 8, whatever the number of elements.
+// Elements of a version are at trie indices [head, tail), 32-bit indices wrap
+// around, so the deque can grow in both directions up to 2^32 elements.
+class PDeque {
+private:
+    struct Version {
+        uint32_t root;
+        uint32_t head;
+        uint32_t tail;
+    };
+    static constexpr uint32_t MIDDLE = 1u << 31;
+
+    PersistentTrie trie{PersistentTrie::MAX_DEPTH, 0};
+    std::vector<Version> versions;
+
+    int add(const Version& v) {
+        versions.push_back(v);
+        return versions.size() - 1;
+    }
+
+public:
+    PDeque() {
+        versions.push_back({trie.initial_root(), MIDDLE, MIDDLE});
+    }
+
+    int push_back(int version, int val) {
+        const Version v = versions[version];
+        return add({trie.set(v.root, v.tail, val), v.head, v.tail + 1});
+    }
+
+    int push_front(int version, int val) {
+        const Version v = versions[version];
+        return add({trie.set(v.root, v.head - 1, val), v.head - 1, v.tail});
+    }
+
+    // pops from the empty deque return 0 and don't create a version
+    int pop_back(int version) {
+        const Version v = versions[version];
+        if (v.head == v.tail) {
+            return 0;
+        }
+        add({v.root, v.head, v.tail - 1});
+        return trie.get(v.root, v.tail - 1);
+    }
+
+    int pop_front(int version) {
+        const Version v = versions[version];
+        if (v.head == v.tail) {
+            return 0;
+        }
+        add({v.root, v.head + 1, v.tail});
+        return trie.get(v.root, v.head);
+    }
+
+    int get(int version, size_t index) const {
+        return trie.get(versions[version].root, versions[version].head + static_cast<uint32_t>(index));
+    }
+
+    size_t size(int version) const {
+        return versions[version].tail - versions[version].head;
+    }
+
+    int version_count() const {
+        return versions.size();
+    }
+};
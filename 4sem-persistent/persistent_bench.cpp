@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "parray.h"
+#include "pqueue.h"
+#include "profile.h"
+#include "pstack.h"
+
+using namespace std;
+
+// Persistent structures against the naive way: a full copy of std::vector per version.
+// Every operation takes the last version, or a random old one with probability 1/10.
+// usage: ./persistent_bench [operation_count]
+
+int ChooseVersion(mt19937& generator, int version_count) {
+    if (uniform_int_distribution(0, 9)(generator) == 0) {
+        return uniform_int_distribution(0, version_count - 1)(generator);
+    }
+    return version_count - 1;
+}
+
+bool IsPush(mt19937& generator) {
+    return uniform_int_distribution(0, 9)(generator) < 6;
+}
+
+void BenchStack(int operation_count) {
+    long long checksum = 0;
+    {
+        LOG_DURATION("PStack");
+        mt19937 generator;
+        PStack stack;
+        for (int i = 0; i < operation_count; ++i) {
+            const int version = ChooseVersion(generator, stack.version_count());
+            if (IsPush(generator)) {
+                stack.push(version, i);
+            } else {
+                checksum += stack.pop(version);
+            }
+        }
+    }
+    long long copy_checksum = 0;
+    {
+        LOG_DURATION("stack, vector copy per version");
+        mt19937 generator;
+        vector<vector<int>> versions(1);
+        for (int i = 0; i < operation_count; ++i) {
+            const int version = ChooseVersion(generator, versions.size());
+            if (IsPush(generator)) {
+                versions.push_back(versions[version]);
+                versions.back().push_back(i);
+            } else if (!versions[version].empty()) {
+                copy_checksum += versions[version].back();
+                versions.emplace_back(versions[version].begin(), versions[version].end() - 1);
+            }
+        }
+    }
+    cout << checksum << " " << copy_checksum << endl;
+}
+
+// Only the last `window` versions are kept, the older ones are released.
+// Without reference counting the nodes of all versions stay in memory.
+template<typename Stack>
+void BenchStackWindow(const string& name, int operation_count, int window) {
+    long long checksum = 0;
+    uint32_t node_count = 0;
+    {
+        LOG_DURATION(name + ", window of " + to_string(window));
+        mt19937 generator;
+        Stack stack;
+        int first_live = 0;
+        for (int i = 0; i < operation_count; ++i) {
+            const int last = stack.version_count() - 1;
+            const int version = uniform_int_distribution(0, 9)(generator) == 0
+                ? uniform_int_distribution(first_live, last)(generator)
+                : last;
+            if (IsPush(generator)) {
+                stack.push(version, i);
+            } else {
+                checksum += stack.pop(version);
+            }
+            if constexpr (is_same_v<Stack, RefCountedPStack>) {
+                while (stack.version_count() - first_live > window) {
+                    stack.release(first_live++);
+                }
+            } else {
+                first_live = max(first_live, stack.version_count() - window);
+            }
+        }
+        node_count = stack.node_count();
+    }
+    cout << checksum << ", nodes in memory: " << node_count << endl;
+}
+
+void BenchQueue(int operation_count) {
+    long long checksum = 0;
+    {
+        LOG_DURATION("PQueue");
+        mt19937 generator;
+        PQueue queue;
+        for (int i = 0; i < operation_count; ++i) {
+            const int version = ChooseVersion(generator, queue.version_count());
+            if (IsPush(generator)) {
+                queue.push(version, i);
+            } else {
+                checksum += queue.pop(version);
+            }
+        }
+    }
+    long long copy_checksum = 0;
+    {
+        LOG_DURATION("queue, vector copy per version");
+        mt19937 generator;
+        vector<vector<int>> versions(1);
+        for (int i = 0; i < operation_count; ++i) {
+            const int version = ChooseVersion(generator, versions.size());
+            if (IsPush(generator)) {
+                versions.push_back(versions[version]);
+                versions.back().push_back(i);
+            } else if (!versions[version].empty()) {
+                copy_checksum += versions[version].front();
+                versions.emplace_back(versions[version].begin() + 1, versions[version].end());
+            }
+        }
+    }
+    cout << checksum << " " << copy_checksum << endl;
+}
+
+void BenchDeque(int operation_count) {
+    long long checksum = 0;
+    {
+        LOG_DURATION("PDeque");
+        mt19937 generator;
+        PDeque deque;
+        for (int i = 0; i < operation_count; ++i) {
+            const int version = ChooseVersion(generator, deque.version_count());
+            const bool front = uniform_int_distribution(0, 1)(generator);
+            if (IsPush(generator)) {
+                front ? deque.push_front(version, i) : deque.push_back(version, i);
+            } else {
+                checksum += front ? deque.pop_front(version) : deque.pop_back(version);
+            }
+        }
+    }
+    long long copy_checksum = 0;
+    {
+        LOG_DURATION("deque, vector copy per version");
+        mt19937 generator;
+        vector<vector<int>> versions(1);
+        for (int i = 0; i < operation_count; ++i) {
+            const int version = ChooseVersion(generator, versions.size());
+            const bool front = uniform_int_distribution(0, 1)(generator);
+            const vector<int>& v = versions[version];
+            if (IsPush(generator)) {
+                vector<int> copy;
+                copy.reserve(v.size() + 1);
+                if (front) {
+                    copy.push_back(i);
+                }
+                copy.insert(copy.end(), v.begin(), v.end());
+                if (!front) {
+                    copy.push_back(i);
+                }
+                versions.push_back(move(copy));
+            } else if (!v.empty()) {
+                copy_checksum += front ? v.front() : v.back();
+                versions.emplace_back(v.begin() + front, v.end() - !front);
+            }
+        }
+    }
+    cout << checksum << " " << copy_checksum << endl;
+}
+
+void BenchArray(int operation_count, int size) {
+    long long checksum = 0;
+    {
+        LOG_DURATION("PArray of " + to_string(size));
+        mt19937 generator;
+        PArray array(size);
+        for (int i = 0; i < operation_count; ++i) {
+            const int version = ChooseVersion(generator, array.version_count());
+            const int index = uniform_int_distribution(0, size - 1)(generator);
+            if (IsPush(generator)) {
+                array.set(version, index, i);
+            } else {
+                checksum += array.get(version, index);
+            }
+        }
+    }
+    long long copy_checksum = 0;
+    {
+        LOG_DURATION("array of " + to_string(size) + ", vector copy per version");
+        mt19937 generator;
+        vector<vector<int>> versions(1, vector<int>(size));
+        for (int i = 0; i < operation_count; ++i) {
+            const int version = ChooseVersion(generator, versions.size());
+            const int index = uniform_int_distribution(0, size - 1)(generator);
+            if (IsPush(generator)) {
+                versions.push_back(versions[version]);
+                versions.back()[index] = i;
+            } else {
+                copy_checksum += versions[version][index];
+            }
+        }
+    }
+    cout << checksum << " " << copy_checksum << endl;
+}
+
+
+int main(int argc, char* argv[]) {
+    const int operation_count = argc > 1 ? stoi(argv[1]) : 20'000;
+
+    BenchStack(operation_count);
+    BenchStackWindow<PStack>("PStack", operation_count, 1'000);
+    BenchStackWindow<RefCountedPStack>("RefCountedPStack", operation_count, 1'000);
+    BenchQueue(operation_count);
+    BenchDeque(operation_count);
+    BenchArray(operation_count, 1'000);
+    BenchArray(operation_count, 10'000);
+}
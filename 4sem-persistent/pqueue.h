@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "node_arena.h"
+
+// Persistent queue with O(1) worst case push and pop
+// (Hood-Melville real-time queue, C. Okasaki "Purely Functional Data Structures", 8.2.1).
+//
+// The queue is two persistent stacks: front (to pop from) and rear (to push to).
+// When rear becomes longer than front, front ++ reverse(rear) becomes the new front.
+// It is not done at once (that would be O(n) for one operation, and with
+// persistence the same expensive version can be popped many times), but by
+// 2 steps per operation: reverse front to front_rev and rear to rear_rev at
+// the same time, then put front_rev back on top of rear_rev. Front has enough
+// elements to serve all pops until the rotation is done.
+//
+// Interface is the same as PStack: version 0 is empty queue, push and pop
+// append a new version.
+
+class PQueue {
+private:
+    struct Node {
+        uint32_t next;
+        int val;
+    };
+    static constexpr uint32_t EMPTY = 0;
+
+    enum State : uint8_t {
+        IDLE,
+        REVERSING,
+        APPENDING,
+        DONE
+    };
+
+    struct Rotation {
+        State state = IDLE;
+        // number of elements of front_rev that are still in the queue
+        int ok = 0;
+        uint32_t front = EMPTY;
+        uint32_t front_rev = EMPTY;
+        uint32_t rear = EMPTY;
+        // the new front when state == DONE
+        uint32_t rear_rev = EMPTY;
+    };
+
+    struct Version {
+        uint32_t front_size = 0;
+        uint32_t rear_size = 0;
+        uint32_t front = EMPTY;
+        uint32_t rear = EMPTY;
+        Rotation rotation;
+    };
+
+    NodeArena<Node> nodes;
+    std::vector<Version> versions;
+
+    uint32_t cons(int val, uint32_t list) {
+        return nodes.allocate({list, val});
+    }
+
+    int head(uint32_t list) const {
+        return nodes[list].val;
+    }
+
+    uint32_t tail(uint32_t list) const {
+        return nodes[list].next;
+    }
+
+    Rotation exec(Rotation r) {
+        if (r.state == REVERSING) {
+            if (r.front != EMPTY) {
+                ++r.ok;
+                r.front_rev = cons(head(r.front), r.front_rev);
+                r.front = tail(r.front);
+                r.rear_rev = cons(head(r.rear), r.rear_rev);
+                r.rear = tail(r.rear);
+            } else {
+                // rear has exactly one element left
+                r.state = APPENDING;
+                r.rear_rev = cons(head(r.rear), r.rear_rev);
+                r.rear = EMPTY;
+            }
+        } else if (r.state == APPENDING) {
+            if (r.ok == 0) {
+                r.state = DONE;
+            } else {
+                --r.ok;
+                r.rear_rev = cons(head(r.front_rev), r.rear_rev);
+                r.front_rev = tail(r.front_rev);
+            }
+        }
+        return r;
+    }
+
+    // the front element was popped: one element less to copy from front_rev
+    Rotation invalidate(Rotation r) const {
+        if (r.state == REVERSING) {
+            --r.ok;
+        } else if (r.state == APPENDING) {
+            if (r.ok == 0) {
+                r.state = DONE;
+                r.rear_rev = tail(r.rear_rev);
+            } else {
+                --r.ok;
+            }
+        }
+        return r;
+    }
+
+    Version exec2(Version q) {
+        q.rotation = exec(exec(q.rotation));
+        if (q.rotation.state == DONE) {
+            q.front = q.rotation.rear_rev;
+            q.rotation = Rotation();
+        }
+        return q;
+    }
+
+    Version check(Version q) {
+        if (q.rear_size <= q.front_size) {
+            return exec2(q);
+        }
+        q.rotation = Rotation();
+        q.rotation.state = REVERSING;
+        q.rotation.front = q.front;
+        q.rotation.rear = q.rear;
+        q.front_size += q.rear_size;
+        q.rear_size = 0;
+        q.rear = EMPTY;
+        return exec2(q);
+    }
+
+public:
+    PQueue() {
+        nodes.allocate({EMPTY, 0});
+        versions.emplace_back();
+    }
+
+    int push(int version, int val) {
+        Version q = versions[version];
+        q.rear = cons(val, q.rear);
+        ++q.rear_size;
+        versions.push_back(check(q));
+        return versions.size() - 1;
+    }
+
+    // pop from the empty queue returns 0 and doesn't create a version
+    int pop(int version) {
+        Version q = versions[version];
+        if (q.front_size == 0) {
+            return 0;
+        }
+        const int val = head(q.front);
+        q.front = tail(q.front);
+        --q.front_size;
+        q.rotation = invalidate(q.rotation);
+        versions.push_back(check(q));
+        return val;
+    }
+
+    int front(int version) const {
+        return versions[version].front_size == 0 ? 0 : head(versions[version].front);
+    }
+
+    int size(int version) const {
+        return versions[version].front_size + versions[version].rear_size;
+    }
+
+    int version_count() const {
+        return versions.size();
+    }
+};
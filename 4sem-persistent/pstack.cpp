@@ -1,76 +1,132 @@
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <vector>
-#include <string>
-
-
-// Disclaimer:
-// This is quick version from seminar
-// for understanding basic construction
-// of class.
-// will be changed to normal realization
-
-class PStack {
-private:
-    struct Node {
-        Node* prev;
-        int val;
-
-        Node(): prev(nullptr) {}
-        Node(Node* prev, int val): prev(prev), val(val) {}
-    };
-    std::vector<Node*> versions;
-    int last_index = 0;
-
-public:
-    PStack() {
-        versions.push_back(new Node());
-    }
-
-    // don't delete twice one node
-    ~PStack() {
-        // TODO
+#include "fast_io.h"
+#include "pstack.h"
+
+// usage:
+//   ./pstack < ops.txt               text commands: n, then "push <value> <version>" or "pop <version>"
+//   ./pstack --to-binary < ops.txt   converts text commands to the binary op-log,
+//                                    fails on an unknown command
+//   ./pstack --binary < ops.bin      replays the binary op-log
+// Both modes print the result of every pop on its own line.
+//
+// Binary op-log (little-endian, as on x86): "PSTK", uint32 count, then count records:
+//   uint32 version << 1 | is_push, and int32 value for pushes only.
+// So a pop is 4 bytes and a push 8 bytes, no parsing at all.
+
+const char OP_LOG_MAGIC[4] = {'P', 'S', 'T', 'K'};
+
+void WriteRecord(FastWriter& out, uint32_t version, bool is_push, int32_t value) {
+    const uint32_t word = version << 1 | is_push;
+    out.write(&word, sizeof(word));
+    if (is_push) {
+        out.write(&value, sizeof(value));
     }
+}
 
-    int pop(int version) {
-        Node* node = versions[version];
+int RunText() {
+    FastReader in;
+    FastWriter out;
+    PStack stack;
+    const int n = in.read_int();
 
-        if (node->prev) {
-            versions.push_back(node->prev);
+    for (int i = 0; i != n; ++i) {
+        // "push" and "pop" differ in the second byte, the rest of the word is not read
+        const char first = in.get();
+        const char second = in.get_in_word();
+        in.skip_word();
+        switch (first == 'p' ? second : 0) {
+            case 'u': {
+                const int value = in.read_int();
+                const int version = in.read_int();
+                stack.push(version, value);
+                break;
+            }
+            case 'o':
+                out.write_int(stack.pop(in.read_int()));
+                out.write_char('\n');
+                break;
+            default:
+                out.write("no such operation\n", 18);
         }
-
-        return node->val;
     }
 
-    void push(int version, int val) {
-        Node* node = versions[version];
-        versions.push_back(new Node(node, val));
+    return 0;
+}
+
+int ConvertToBinary() {
+    FastReader in;
+    FastWriter out;
+    const uint32_t n = in.read_int();
+    out.write(OP_LOG_MAGIC, sizeof(OP_LOG_MAGIC));
+    out.write(&n, sizeof(n));
+
+    for (uint32_t i = 0; i != n; ++i) {
+        // the same check as in RunText, but an unknown operation can't be replayed
+        const char first = in.get();
+        const char second = in.get_in_word();
+        in.skip_word();
+        switch (first == 'p' ? second : 0) {
+            case 'u': {
+                const int value = in.read_int();
+                WriteRecord(out, in.read_int(), true, value);
+                break;
+            }
+            case 'o':
+                WriteRecord(out, in.read_int(), false, 0);
+                break;
+            default:
+                std::cerr << "no such operation at command " << i << std::endl;
+                return 1;
+        }
     }
 
+    return 0;
+}
 
-};
+int RunBinary() {
+    FastReader in;
+    FastWriter out;
+    char magic[sizeof(OP_LOG_MAGIC)];
+    uint32_t n;
+    if (in.read(magic, sizeof(magic)) != sizeof(magic) || std::memcmp(magic, OP_LOG_MAGIC, sizeof(magic)) != 0
+        || in.read(&n, sizeof(n)) != sizeof(n)) {
+        std::cerr << "not a PStack op-log" << std::endl;
+        return 1;
+    }
 
-int main() {
     PStack stack;
-    int n;
-    std::cin >> n;
-
-    std::string operation;
-    int version;
-    int value;
-
-    for (int i = 0; i != n; ++i) {
-        std::cin >> operation;
-        if (operation == "push") {
-            std::cin >> value >> version;
-            stack.push(value, version);
-        } else if (operation == "pop") {
-            std::cin >> version;
-            int res = stack.pop(version);
-            std::cout << res << std::endl;
+    for (uint32_t i = 0; i != n; ++i) {
+        uint32_t word;
+        if (in.read(&word, sizeof(word)) != sizeof(word)) {
+            std::cerr << "op-log is truncated at record " << i << std::endl;
+            return 1;
+        }
+        const int version = word >> 1;
+        if (word & 1) {
+            int32_t value;
+            if (in.read(&value, sizeof(value)) != sizeof(value)) {
+                std::cerr << "op-log is truncated at record " << i << std::endl;
+                return 1;
+            }
+            stack.push(version, value);
         } else {
-            std::cout << "no such operation" << std::endl;
+            out.write_int(stack.pop(version));
+            out.write_char('\n');
         }
     }
 
     return 0;
 }
+
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--to-binary") == 0) {
+        return ConvertToBinary();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--binary") == 0) {
+        return RunBinary();
+    }
+    return RunText();
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include "node_arena.h"
+
+// Persistent structures of this folder have the same interface:
+// version 0 is the initial (empty) structure, every modifying operation
+// takes the version to modify and appends a new version,
+// its number is version_count() - 1.
+//
+// By default nothing is ever freed: all nodes live until the structure dies.
+// The stacks can also count references (COUNT_REFERENCES = true): then
+// release(version) says the version won't be used anymore, and the nodes
+// that no live version can reach go back to the arena for the next pushes.
+// A version may be referenced by a node, so a node keeps a counter of
+// versions and nodes pointing to it. The counter costs 4 bytes per node
+// and an increment per operation, so it's off by default.
+// Version ids are not reused: the table of versions still grows by 4 bytes
+// per operation, only the nodes are collected.
+
+namespace PStackDetail {
+
+    struct Node {
+        uint32_t prev;
+        int val;
+    };
+
+    template<typename Refs>
+    struct CountedNode {
+        uint32_t prev;
+        int val;
+        // versions and nodes pointing to this node
+        Refs refs;
+    };
+
+    constexpr uint32_t EMPTY = 0;
+    constexpr uint32_t RELEASED = UINT32_MAX;
+
+}
+
+
+template<bool COUNT_REFERENCES = false>
+class BasicPStack {
+private:
+    // prev is the index of the previous node in the arena,
+    // node 0 is the bottom of every stack (empty stack), it's never released
+    using Node = std::conditional_t<COUNT_REFERENCES, PStackDetail::CountedNode<uint32_t>, PStackDetail::Node>;
+    static constexpr uint32_t EMPTY = PStackDetail::EMPTY;
+
+    NodeArena<Node> nodes;
+    std::vector<uint32_t> versions;
+
+    void add_reference(uint32_t node) {
+        if constexpr (COUNT_REFERENCES) {
+            ++nodes[node].refs;
+        }
+    }
+
+public:
+    BasicPStack() {
+        if constexpr (COUNT_REFERENCES) {
+            versions.push_back(nodes.allocate({EMPTY, 0, 1}));
+        } else {
+            versions.push_back(nodes.allocate({EMPTY, 0}));
+        }
+    }
+
+    // pop from the empty stack returns 0 and doesn't create a version
+    int pop(int version) {
+        const uint32_t node = versions[version];
+        if (node == EMPTY) {
+            return 0;
+        }
+
+        add_reference(nodes[node].prev);
+        versions.push_back(nodes[node].prev);
+        return nodes[node].val;
+    }
+
+    int push(int version, int val) {
+        const uint32_t prev = versions[version];
+        add_reference(prev);
+        if constexpr (COUNT_REFERENCES) {
+            versions.push_back(nodes.allocate({prev, val, 1}));
+        } else {
+            versions.push_back(nodes.allocate({prev, val}));
+        }
+        return versions.size() - 1;
+    }
+
+    // The version must not be used after that.
+    // Goes down the stack while the nodes become unreachable: a loop,
+    // not a recursion, so a chain of millions of nodes doesn't overflow the stack
+    void release(int version) {
+        static_assert(COUNT_REFERENCES, "release needs BasicPStack<true>");
+        uint32_t node = versions[version];
+        versions[version] = PStackDetail::RELEASED;
+        while (node != EMPTY && --nodes[node].refs == 0) {
+            const uint32_t prev = nodes[node].prev;
+            nodes.deallocate(node);
+            node = prev;
+        }
+    }
+
+    int version_count() const {
+        return versions.size();
+    }
+
+    // nodes in use, including the bottom one
+    uint32_t node_count() const {
+        return nodes.count();
+    }
+};
+
+using PStack = BasicPStack<false>;
+using RefCountedPStack = BasicPStack<true>;
+
+
+// PStack for many threads: push and pop may be called concurrently,
+// also on the same version.
+// Version ids come from an atomic counter, the table of versions is a
+// ConcurrentNodeArena: it is never reallocated, so reading an old version
+// doesn't wait for writers. The new version is published with a release
+// store, so it can be used by any thread that got its id from the creator.
+//
+// With COUNT_REFERENCES the counters are atomic. release may run concurrently
+// with operations on other versions, but the caller must know that nobody
+// uses the released version anymore (as with delete of a shared object).
+template<bool COUNT_REFERENCES = false>
+class BasicConcurrentPStack {
+private:
+    using Node = std::conditional_t<COUNT_REFERENCES, PStackDetail::CountedNode<std::atomic<uint32_t>>, PStackDetail::Node>;
+    static constexpr uint32_t EMPTY = PStackDetail::EMPTY;
+
+    ConcurrentNodeArena<Node> nodes;
+    ConcurrentNodeArena<std::atomic<uint32_t>> versions;
+
+    uint32_t top(int version) const {
+        return versions[version].load(std::memory_order_acquire);
+    }
+
+    int add_version(uint32_t node) {
+        const uint32_t version = versions.allocate();
+        versions[version].store(node, std::memory_order_release);
+        return version;
+    }
+
+    // atomics can't be copied, so the node is filled field by field
+    uint32_t new_node(uint32_t prev, int val) {
+        if constexpr (COUNT_REFERENCES) {
+            const uint32_t index = nodes.allocate();
+            Node& node = nodes[index];
+            node.prev = prev;
+            node.val = val;
+            node.refs.store(1, std::memory_order_relaxed);
+            return index;
+        } else {
+            return nodes.allocate({prev, val});
+        }
+    }
+
+    // the node is reachable from a live version, so the counter is > 0 and
+    // can't drop to zero meanwhile: relaxed is enough, as for shared_ptr
+    void add_reference(uint32_t node) {
+        if constexpr (COUNT_REFERENCES) {
+            nodes[node].refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    struct Popped {
+        int val;
+        int version;
+    };
+
+    BasicConcurrentPStack() {
+        add_version(new_node(EMPTY, 0));
+    }
+
+    // returns the new version, not version_count() - 1: other threads push too
+    int push(int version, int val) {
+        const uint32_t prev = top(version);
+        add_reference(prev);
+        return add_version(new_node(prev, val));
+    }
+
+    // nullopt for the empty stack
+    std::optional<Popped> pop(int version) {
+        const uint32_t node = top(version);
+        if (node == EMPTY) {
+            return std::nullopt;
+        }
+        const Node& popped = nodes[node];
+        add_reference(popped.prev);
+        return Popped{popped.val, add_version(popped.prev)};
+    }
+
+    // acq_rel on the decrement: the thread that frees a node sees
+    // all the reads of it done by the threads that dropped their references
+    void release(int version) {
+        static_assert(COUNT_REFERENCES, "release needs BasicConcurrentPStack<true>");
+        uint32_t node = versions[version].exchange(PStackDetail::RELEASED, std::memory_order_acquire);
+        while (node != EMPTY && nodes[node].refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            const uint32_t prev = nodes[node].prev;
+            nodes.deallocate(node);
+            node = prev;
+        }
+    }
+
+    // includes the versions that are being created right now
+    int version_count() const {
+        return versions.count();
+    }
+
+    uint32_t node_count() const {
+        return nodes.count();
+    }
+};
+
+using ConcurrentPStack = BasicConcurrentPStack<false>;
+using RefCountedConcurrentPStack = BasicConcurrentPStack<true>;
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "profile.h"
+#include "pstack.h"
+
+using namespace std;
+
+// Many threads create versions of one stack: ConcurrentPStack against PStack under a mutex.
+// Every thread works with its last version, or with one of the first
+// BASE_VERSIONS versions (created before the threads start) with probability 1/10.
+// usage: ./pstack_concurrent_bench [operation_count]
+
+constexpr int BASE_VERSIONS = 1000;
+
+template<typename Stack>
+void FillBase(Stack& stack) {
+    for (int i = 1; i < BASE_VERSIONS; ++i) {
+        stack.push(i - 1, i);
+    }
+}
+
+template<typename Work>
+void RunThreads(int thread_count, int operation_count, Work work) {
+    vector<thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back(work, t, operation_count / thread_count);
+    }
+    for (thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void BenchConcurrent(int thread_count, int operation_count) {
+    ConcurrentPStack stack;
+    FillBase(stack);
+    LOG_DURATION("ConcurrentPStack, " + to_string(thread_count) + " threads");
+    RunThreads(thread_count, operation_count, [&stack](int seed, int count) {
+        mt19937 generator(seed);
+        int mine = BASE_VERSIONS - 1;
+        for (int i = 0; i < count; ++i) {
+            const int r = uniform_int_distribution(0, 9)(generator);
+            const int version = r == 0 ? uniform_int_distribution(0, BASE_VERSIONS - 1)(generator) : mine;
+            if (r < 6) {
+                mine = stack.push(version, i);
+            } else if (const auto popped = stack.pop(version)) {
+                mine = popped->version;
+            }
+        }
+    });
+}
+
+void BenchMutex(int thread_count, int operation_count) {
+    PStack stack;
+    FillBase(stack);
+    mutex stack_mutex;
+    LOG_DURATION("PStack + mutex, " + to_string(thread_count) + " threads");
+    RunThreads(thread_count, operation_count, [&stack, &stack_mutex](int seed, int count) {
+        mt19937 generator(seed);
+        int mine = BASE_VERSIONS - 1;
+        for (int i = 0; i < count; ++i) {
+            const int r = uniform_int_distribution(0, 9)(generator);
+            const int version = r == 0 ? uniform_int_distribution(0, BASE_VERSIONS - 1)(generator) : mine;
+            lock_guard guard(stack_mutex);
+            if (r < 6) {
+                mine = stack.push(version, i);
+            } else {
+                const int version_count = stack.version_count();
+                stack.pop(version);
+                if (stack.version_count() != version_count) {
+                    mine = version_count;
+                }
+            }
+        }
+    });
+}
+
+
+int main(int argc, char* argv[]) {
+    const int operation_count = argc > 1 ? stoi(argv[1]) : 10'000'000;
+
+    for (int thread_count = 1; thread_count <= 32; thread_count *= 2) {
+        BenchMutex(thread_count, operation_count);
+        BenchConcurrent(thread_count, operation_count);
+    }
+}
@@ -1,16 +1,31 @@
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <execution>
 #include <functional>
 #include <iostream>
-#include <random>
+#include <memory_resource>
+#include <numeric>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include "profile.h"
+#include "query_arena.h"
+#include "workload.h"
 
 using namespace std;
 
-vector<string> SplitIntoWords(string_view text) {
-    vector<string> words = {""};
+// usage: ./a1_parse_query [kernel | alloc]
+// kernel - only CountWords against SplitIntoWords under seq / par / par_unseq,
+// on the short queries and on long ones (up to 200 characters)
+// alloc - SplitIntoWords with the words in malloc and in a monotonic_buffer_resource
+// per query under seq / par / par_unseq, in the thread's QueryArena under seq / par
+
+// the vector and the words (longer than SSO) are allocated in resource
+pmr::vector<pmr::string> SplitIntoWords(string_view text, pmr::memory_resource* resource = pmr::get_default_resource()) {
+    pmr::vector<pmr::string> words(resource);
+    words.emplace_back();
     for (const char c : text) {
         if (c == ' ') {
             words.emplace_back();
@@ -21,31 +36,104 @@ vector<string> SplitIntoWords(string_view text) {
     return words;
 }
 
-string GenerateQuery(mt19937& generator, int max_length, int space_rate) {
-    const int length = uniform_int_distribution(1, max_length)(generator);
-    string query(length, ' ');
-    for (char& c : query) {
-        const int rnd = uniform_int_distribution(0, space_rate - 1)(generator);
-        if (rnd > 0) {
-            c = 'a' + (rnd - 1);
+// SplitIntoWords(text).size() without building the words: every space starts
+// a new (maybe empty) word. No allocations, no locks, no branches on the data,
+// so it is allowed under par_unseq (the element function may be interleaved
+// with others in one thread, malloc inside it is not). 8 bytes at a time:
+// x ^ 0x2020... has zero bytes at the spaces, the high bit of
+// ((y & 0x7f) + 0x7f) | y is set exactly for the nonzero bytes of y.
+size_t CountWords(string_view text) {
+    constexpr uint64_t SPACES = 0x2020202020202020;
+    constexpr uint64_t LOW_BITS = 0x7f7f7f7f7f7f7f7f;
+    size_t spaces = 0;
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        uint64_t block;
+        memcpy(&block, text.data() + i, sizeof(block));
+        const uint64_t y = block ^ SPACES;
+        const uint64_t nonzero = (((y & LOW_BITS) + LOW_BITS) | y) & ~LOW_BITS;
+        spaces += 8 - __builtin_popcountll(nonzero);
+    }
+    for (; i < text.size(); ++i) {
+        spaces += text[i] == ' ';
+    }
+    return spaces + 1;
+}
+
+// the i-th query depends only on (seed, i), so queries are generated in parallel
+StringArena GenerateQueries(uint64_t seed, int query_count, int max_length, int space_rate) {
+    return StringArena::Generate(query_count, seed, [max_length, space_rate](PhiloxRng& rng, string& out) {
+        const int length = rng.UniformInt(1, max_length);
+        for (int i = 0; i < length; ++i) {
+            const int rnd = rng.UniformInt(0, space_rate - 1);
+            out.push_back(rnd > 0 ? 'a' + (rnd - 1) : ' ');
         }
+    });
+}
+
+template<typename Policy, typename Counter>
+void BenchWordCount(const string& title, Policy policy, const StringArena& queries, Counter counter) {
+    vector<int> word_counts(queries.size());
+    {
+        LOG_DURATION(title);
+        transform(policy, queries.begin(), queries.end(), word_counts.begin(), counter);
     }
-    return query;
+    cout << reduce(word_counts.begin(), word_counts.end(), int64_t{0}) << endl;
+}
+
+void BenchKernel(const StringArena& queries) {
+    auto split = [](string_view query) {
+        return SplitIntoWords(query).size();
+    };
+    BenchWordCount("  SplitIntoWords seq", execution::seq, queries, split);
+    BenchWordCount("  SplitIntoWords par", execution::par, queries, split);
+    BenchWordCount("  SplitIntoWords par_unseq", execution::par_unseq, queries, split);
+    BenchWordCount("  CountWords seq", execution::seq, queries, CountWords);
+    BenchWordCount("  CountWords par", execution::par, queries, CountWords);
+    BenchWordCount("  CountWords par_unseq", execution::par_unseq, queries, CountWords);
 }
 
-vector<string> GenerateQueries(mt19937& generator, int query_count, int max_length, int space_rate) {
-    vector<string> queries;
-    queries.reserve(query_count);
-    for (int i = 0; i < query_count; ++i) {
-        queries.push_back(GenerateQuery(generator, max_length, space_rate));
+template<typename Policy>
+void BenchAllocators(const string& policy_name, Policy policy, const StringArena& queries) {
+    BenchWordCount("  malloc " + policy_name, policy, queries, [](string_view query) {
+        return SplitIntoWords(query, pmr::new_delete_resource()).size();
+    });
+    BenchWordCount("  monotonic " + policy_name, policy, queries, [](string_view query) {
+        byte buffer[1024];
+        pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer));
+        return SplitIntoWords(query, &resource).size();
+    });
+    // the thread's arena can't be shared by interleaved element functions (query_arena.h)
+    if constexpr (!is_same_v<Policy, execution::parallel_unsequenced_policy>) {
+        BenchWordCount("  arena " + policy_name, policy, queries, [](string_view query) {
+            QueryArenaScope scope;
+            return SplitIntoWords(query, scope.resource()).size();
+        });
     }
-    return queries;
 }
 
+void BenchAllocators(const StringArena& queries) {
+    BenchAllocators("seq", execution::seq, queries);
+    BenchAllocators("par", execution::par, queries);
+    BenchAllocators("par_unseq", execution::par_unseq, queries);
+}
 
-int main() {
-    mt19937 generator;
-    const auto queries = GenerateQueries(generator, 20000000, 2, 4);
+int main(int argc, char* argv[]) {
+    const auto queries = GenerateQueries(42, 20000000, 2, 4);
+    if (argc > 1 && string_view(argv[1]) == "kernel") {
+        cerr << "short queries" << endl;
+        BenchKernel(queries);
+        cerr << "long queries" << endl;
+        BenchKernel(GenerateQueries(43, 1000000, 200, 8));
+        return 0;
+    }
+    if (argc > 1 && string_view(argv[1]) == "alloc") {
+        cerr << "short queries" << endl;
+        BenchAllocators(queries);
+        cerr << "long queries" << endl;
+        BenchAllocators(GenerateQueries(43, 1000000, 200, 8));
+        return 0;
+    }
 
     {
         vector<int> word_counts(queries.size());
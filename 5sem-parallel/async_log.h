@@ -0,0 +1,228 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "mpmc_queue.h"
+
+// Logger for many threads without a mutex around std::cout.
+// The line is formatted in a thread-local buffer of the calling thread and
+// pushed to a lock-free queue; one background thread takes lines from the
+// queue and writes them to the fd in big batches.
+//
+//   AsyncLog::Instance().WriteLine("got: ", m);
+//
+// Lines of one thread keep their order, lines of different threads are never
+// mixed up. Everything is written when the logger is destroyed (end of main
+// for Instance()), on Flush() and in std::terminate (uncaught exception).
+// In std::terminate the flush waits at most TERMINATE_FLUSH_TIMEOUT and is
+// skipped if the writer has stopped or terminate is called on the writer
+// thread itself; then the previous terminate handler is called.
+class AsyncLog {
+public:
+    explicit AsyncLog(int fd = STDOUT_FILENO, size_t queue_capacity = 1 << 14)
+        : fd_(fd)
+        , queue_(queue_capacity)
+        , writer_([this] { WriterLoop(); })
+    {
+    }
+
+    AsyncLog(const AsyncLog&) = delete;
+    AsyncLog& operator=(const AsyncLog&) = delete;
+
+    // other threads must not log at this point
+    ~AsyncLog() {
+        AsyncLog* self = this;
+        terminate_log_.compare_exchange_strong(self, nullptr);
+        Record stop;
+        stop.kind = Record::STOP;
+        queue_.Push(std::move(stop));
+        writer_.join();
+    }
+
+    // logger for stdout, flushed at exit and on std::terminate
+    static AsyncLog& Instance() {
+        static AsyncLog log;
+        static const bool is_handler_set = [] {
+            terminate_log_.store(&log);
+            previous_terminate_ = std::set_terminate(OnTerminate);
+            return true;
+        }();
+        (void) is_handler_set;
+        return log;
+    }
+
+    template<typename... Args>
+    void WriteLine(const Args&... args) {
+        LineStream& line = ThreadLine();
+        line.buffer.clear();
+        (line.stream << ... << args) << '\n';
+
+        Record record;
+        record.size = line.buffer.size();
+        if (record.size <= Record::INLINE_SIZE) {
+            std::memcpy(record.text, line.buffer.data(), record.size);
+        } else {
+            record.long_text = line.buffer;
+        }
+        // waits only if the writer is behind by the whole queue
+        queue_.Push(std::move(record));
+    }
+
+    // returns when everything logged before the call is written to the fd
+    void Flush() {
+        std::atomic<bool> done = false;
+        Record flush;
+        flush.kind = Record::FLUSH;
+        flush.done = &done;
+        queue_.Push(std::move(flush));
+        while (!done.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    struct Record {
+        static constexpr size_t INLINE_SIZE = 200;
+
+        enum Kind {
+            TEXT,
+            FLUSH,
+            STOP
+        };
+
+        Kind kind = TEXT;
+        size_t size = 0;
+        char text[INLINE_SIZE] = {};
+        // only for lines longer than INLINE_SIZE
+        std::string long_text;
+        std::atomic<bool>* done = nullptr;
+    };
+
+    // std::ostream printing to a std::string that is reused between calls,
+    // so formatting a line doesn't allocate
+    struct LineStream : std::streambuf {
+        std::string buffer;
+        std::ostream stream{this};
+
+        int_type overflow(int_type ch) override {
+            if (ch != traits_type::eof()) {
+                buffer.push_back(static_cast<char>(ch));
+            }
+            return ch;
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            buffer.append(s, n);
+            return n;
+        }
+    };
+
+    static LineStream& ThreadLine() {
+        thread_local LineStream line;
+        return line;
+    }
+
+    // like Flush, but gives up after timeout; false if nothing was flushed
+    bool TryFlush(std::chrono::milliseconds timeout) {
+        if (!is_writer_running_.load(std::memory_order_acquire) || std::this_thread::get_id() == writer_.get_id()) {
+            return false;
+        }
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        // a member, not a local: the writer may set it after we gave up
+        terminate_flushed_.store(false);
+        Record flush;
+        flush.kind = Record::FLUSH;
+        flush.done = &terminate_flushed_;
+        while (!queue_.TryPush(std::move(flush))) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        while (!terminate_flushed_.load(std::memory_order_acquire)) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    static void OnTerminate() {
+        if (AsyncLog* log = terminate_log_.load()) {
+            log->TryFlush(TERMINATE_FLUSH_TIMEOUT);
+        }
+        if (previous_terminate_ != nullptr) {
+            previous_terminate_();
+        }
+        std::abort();
+    }
+
+    void WriterLoop() {
+        static constexpr size_t BATCH_SIZE = 1 << 16;
+        std::string batch;
+        batch.reserve(BATCH_SIZE + Record::INLINE_SIZE);
+        Record record;
+        while (true) {
+            bool is_idle = true;
+            while (batch.size() < BATCH_SIZE && queue_.TryPop(record)) {
+                is_idle = false;
+                if (record.kind == Record::TEXT) {
+                    if (record.size <= Record::INLINE_SIZE) {
+                        batch.append(record.text, record.size);
+                    } else {
+                        batch += record.long_text;
+                    }
+                    continue;
+                }
+                WriteAll(batch);
+                if (record.kind == Record::STOP) {
+                    is_writer_running_.store(false, std::memory_order_release);
+                    return;
+                }
+                record.done->store(true, std::memory_order_release);
+            }
+            WriteAll(batch);
+            if (is_idle) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    void WriteAll(std::string& batch) {
+        size_t written = 0;
+        while (written < batch.size()) {
+            const ssize_t result = write(fd_, batch.data() + written, batch.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            written += result;
+        }
+        batch.clear();
+    }
+
+    static constexpr std::chrono::milliseconds TERMINATE_FLUSH_TIMEOUT{1000};
+
+    // Instance() while it is alive, and the handler it replaced
+    inline static std::atomic<AsyncLog*> terminate_log_ = nullptr;
+    inline static std::terminate_handler previous_terminate_ = nullptr;
+
+    const int fd_;
+    BoundedMPMCQueue<Record> queue_;
+    std::atomic<bool> terminate_flushed_ = false;
+    std::atomic<bool> is_writer_running_ = true;
+    // the last member: the writer starts when everything else is constructed
+    std::thread writer_;
+};
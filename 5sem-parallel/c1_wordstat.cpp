@@ -1,21 +1,26 @@
 #include <algorithm>
 #include <atomic>
+#include <deque>
 #include <execution>
 #include <future>
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <mutex>
-#include <random>
+#include <numeric>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include "profile.h"
+#include "query_arena.h"
+#include "workload.h"
 
 using namespace std;
 
 
-vector<string_view> SplitIntoWords(string_view text) {
-    vector<string_view> words;
+pmr::vector<string_view> SplitIntoWords(string_view text, pmr::memory_resource* resource = pmr::get_default_resource()) {
+    pmr::vector<string_view> words(resource);
     while (true) {
         const size_t space_pos = text.find(' ');
         words.push_back(text.substr(0, space_pos));
@@ -33,13 +38,19 @@ class SearchServer {
 public:
     void AddDocument(int document_id, string_view text) {
         for (const string_view word : SplitIntoWords(text)) {
-            word_to_documents_[string(word)].insert(document_id);
+            auto documents_it = word_to_documents_.find(word);
+            if (documents_it == word_to_documents_.end()) {
+                documents_it = word_to_documents_.emplace(words_.emplace_back(word), unordered_set<int>{}).first;
+            }
+            documents_it->second.insert(document_id);
         }
     }
-    vector<int> Find(string_view query) const {
-        vector<int> documents;
-        for (const string_view word : SplitIntoWords(query)) {
-            const auto documents_it = word_to_documents_.find(string(word));
+    // the words of the query and the result are allocated in resource,
+    // nothing else is allocated
+    pmr::vector<int> Find(string_view query, pmr::memory_resource* resource = pmr::get_default_resource()) const {
+        pmr::vector<int> documents(resource);
+        for (const string_view word : SplitIntoWords(query, resource)) {
+            const auto documents_it = word_to_documents_.find(word);
             if (documents_it != word_to_documents_.end()) {
                 documents.insert(documents.end(), documents_it->second.begin(), documents_it->second.end());
             }
@@ -49,48 +60,31 @@ public:
     }
 
 private:
-    unordered_map<string, unordered_set<int>> word_to_documents_;
+    // the keys point into words_, a deque doesn't move its elements
+    deque<string> words_;
+    unordered_map<string_view, unordered_set<int>> word_to_documents_;
 };
 
-string GenerateWord(mt19937& generator, int max_length) {
-    const int length = uniform_int_distribution(1, max_length)(generator);
-    string word;
-    word.reserve(length);
-    for (int i = 0; i < length; ++i) {
-        word.push_back(uniform_int_distribution('a', 'z')(generator));
-    }
-    return word;
-}
-
-vector<string> GenerateDictionary(mt19937& generator, int word_count, int max_length) {
-    vector<string> words;
-    words.reserve(word_count);
-    for (int i = 0; i < word_count; ++i) {
-        words.push_back(GenerateWord(generator, max_length));
-    }
-    words.erase(unique(words.begin(), words.end()), words.end());
-    return words;
-}
-
-string GenerateQuery(mt19937& generator, const vector<string>& dictionary, int max_word_count) {
-    const int word_count = uniform_int_distribution(1, max_word_count)(generator);
-    string query;
-    for (int i = 0; i < word_count; ++i) {
-        if (!query.empty()) {
-            query.push_back(' ');
+// the i-th word/query depends only on (seed, i), so they are generated in parallel
+StringArena GenerateDictionary(uint64_t seed, int word_count, int max_length) {
+    return StringArena::Generate(word_count, seed, [max_length](PhiloxRng& rng, string& out) {
+        const int length = rng.UniformInt(1, max_length);
+        for (int i = 0; i < length; ++i) {
+            out.push_back(rng.UniformInt('a', 'z'));
         }
-        query += dictionary[uniform_int_distribution<int>(0, dictionary.size() - 1)(generator)];
-    }
-    return query;
+    });
 }
 
-vector<string> GenerateQueries(mt19937& generator, const vector<string>& dictionary, int query_count, int max_word_count) {
-    vector<string> queries;
-    queries.reserve(query_count);
-    for (int i = 0; i < query_count; ++i) {
-        queries.push_back(GenerateQuery(generator, dictionary, max_word_count));
-    }
-    return queries;
+StringArena GenerateQueries(uint64_t seed, const StringArena& dictionary, int query_count, int max_word_count) {
+    return StringArena::Generate(query_count, seed, [&dictionary, max_word_count](PhiloxRng& rng, string& out) {
+        const int word_count = rng.UniformInt(1, max_word_count);
+        for (int i = 0; i < word_count; ++i) {
+            if (i > 0) {
+                out.push_back(' ');
+            }
+            out += dictionary[rng.UniformInt(0, dictionary.size() - 1)];
+        }
+    });
 }
 
 template<typename Value>
@@ -102,21 +96,59 @@ int ComputeTotalWordStat(const unordered_map<string, Value>& word_stat) {
     return result;
 }
 
+// Find alone, its temporaries in malloc, in a monotonic_buffer_resource per
+// query and (not under par_unseq) in the thread's QueryArena
+template<typename Policy>
+void BenchFind(const string& policy_name, Policy policy, const SearchServer& search_server, const StringArena& queries) {
+    auto bench = [&](const string& title, auto find) {
+        vector<int> results(queries.size());
+        {
+            LOG_DURATION(title + " " + policy_name);
+            transform(policy, queries.begin(), queries.end(), results.begin(), find);
+        }
+        cout << accumulate(results.begin(), results.end(), 0) << endl;
+    };
+    bench("Find malloc", [&search_server](string_view query) {
+        return search_server.Find(query, pmr::new_delete_resource()).size();
+    });
+    bench("Find monotonic", [&search_server](string_view query) {
+        byte buffer[4096];
+        pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer));
+        return search_server.Find(query, &resource).size();
+    });
+    // the thread's arena can't be shared by interleaved element functions (query_arena.h)
+    if constexpr (!is_same_v<Policy, execution::parallel_unsequenced_policy>) {
+        bench("Find arena", [&search_server](string_view query) {
+            QueryArenaScope scope;
+            return search_server.Find(query, scope.resource()).size();
+        });
+    }
+}
+
 
-int main() {
-    LOG_DURATION("all");
-    mt19937 generator;
-    const auto dictionary = GenerateDictionary(generator, 1'000, 25);
-    const auto documents = GenerateQueries(generator, dictionary, 100'000, 10);
+// usage: ./c1_wordstat [alloc]
+// alloc - only BenchFind: Find with malloc / monotonic_buffer_resource / QueryArena
+int main(int argc, char* argv[]) {
+    const bool bench_allocators = argc > 1 && string_view(argv[1]) == "alloc";
+    LOG_DURATION(bench_allocators ? "alloc" : "all");
+    const auto dictionary = GenerateDictionary(1, 1'000, 25);
+    const auto documents = GenerateQueries(2, dictionary, 100'000, 10);
     SearchServer search_server;
     for (size_t i = 0; i < documents.size(); ++i) {
         search_server.AddDocument(i, documents[i]);
     }
 
-    const auto queries = GenerateQueries(generator, dictionary, 10'000, 7);
+    const auto queries = GenerateQueries(3, dictionary, 10'000, 7);
 
     cout << "prepared" << endl;
 
+    if (bench_allocators) {
+        BenchFind("seq", execution::seq, search_server, queries);
+        BenchFind("par", execution::par, search_server, queries);
+        BenchFind("par_unseq", execution::par_unseq, search_server, queries);
+        return 0;
+    }
+
     {
         vector<int> results(queries.size());
         unordered_map<string, int> word_stat;
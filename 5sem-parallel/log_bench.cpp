@@ -0,0 +1,62 @@
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "async_log.h"
+#include "profile.h"
+
+using namespace std;
+
+// Every thread logs line_count lines to /dev/null.
+// usage: ./log_bench [line_count]
+
+template<typename LogLine>
+void RunThreads(int thread_count, int line_count, LogLine log_line) {
+    vector<thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([t, line_count, &log_line] {
+            for (int i = 0; i < line_count; ++i) {
+                log_line(t, i);
+            }
+        });
+    }
+    for (thread& thread : threads) {
+        thread.join();
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    const int line_count = argc > 1 ? stoi(argv[1]) : 1'000'000;
+    const int fd = open("/dev/null", O_WRONLY);
+
+    for (int thread_count = 1; thread_count <= 16; thread_count *= 2) {
+        const string threads = " " + to_string(thread_count) + " threads";
+        {
+            // what std::cout << ... << std::endl under lock_guard does
+            mutex write_mutex;
+            LOG_DURATION("mutex + write per line" + threads);
+            RunThreads(thread_count, line_count, [fd, &write_mutex](int t, int i) {
+                const string line = "thread " + to_string(t) + " got: " + to_string(i) + "\n";
+                lock_guard guard(write_mutex);
+                if (write(fd, line.data(), line.size()) < 0) {
+                    abort();
+                }
+            });
+        }
+        {
+            AsyncLog log(fd);
+            LOG_DURATION("async log" + threads);
+            {
+                LOG_DURATION("async log, without final flush" + threads);
+                RunThreads(thread_count, line_count, [&log](int t, int i) {
+                    log.WriteLine("thread ", t, " got: ", i);
+                });
+            }
+            log.Flush();
+        }
+    }
+    close(fd);
+}
@@ -0,0 +1,404 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Queues for passing items between threads (many producers, many consumers).
+//   BoundedMPMCQueue   - lock-free ring of fixed capacity (D. Vyukov)
+//   SegmentedMPMCQueue - lock-free unbounded list of array segments
+//                        (FAAArrayQueue by P. Ramalhete and A. Correia)
+//   BlockingQueue      - std::deque under mutex + condition_variable, for comparison
+//
+// All three have TryPush/TryPop that never wait and Push/Pop that wait
+// until the operation is possible.
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+
+template<typename T>
+class BoundedMPMCQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit BoundedMPMCQueue(size_t capacity)
+        : mask_(RoundUpToPowerOfTwo(capacity) - 1)
+        , cells_(new Cell[mask_ + 1])
+    {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMPMCQueue(const BoundedMPMCQueue&) = delete;
+    BoundedMPMCQueue& operator=(const BoundedMPMCQueue&) = delete;
+
+    // cell.sequence == pos       - cell is free for the producer with ticket pos
+    // cell.sequence == pos + 1   - cell holds the value for the consumer with ticket pos
+    // value is moved from only on success
+    bool TryPush(T&& value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // the consumer hasn't freed this cell yet: full
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(const T& value) {
+        return TryPush(T(value));
+    }
+
+    bool TryPop(T& value) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // the producer hasn't filled this cell yet: empty
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    void Push(T value) {
+        while (!TryPush(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    void Pop(T& value) {
+        while (!TryPop(value)) {
+            std::this_thread::yield();
+        }
+    }
+
+    size_t Capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    // every cell on its own cache line, so neighbour producers don't
+    // invalidate each other's sequence numbers
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t RoundUpToPowerOfTwo(size_t n) {
+        size_t result = 1;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t mask_;
+    const std::unique_ptr<Cell[]> cells_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_pos_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_pos_{0};
+};
+
+
+// Index of the current thread in [0, MAX_THREADS), is released when the
+// thread finishes. Used for hazard pointers, so no more than MAX_THREADS
+// threads may work with SegmentedMPMCQueue at the same time.
+class ThreadSlot {
+public:
+    static constexpr int MAX_THREADS = 256;
+
+    static int Id() {
+        thread_local ThreadSlot slot;
+        return slot.id_;
+    }
+
+private:
+    ThreadSlot() {
+        for (int i = 0;; i = (i + 1) % MAX_THREADS) {
+            bool expected = false;
+            if (!used_[i].load(std::memory_order_relaxed)
+                && used_[i].compare_exchange_strong(expected, true)) {
+                id_ = i;
+                return;
+            }
+        }
+    }
+
+    ~ThreadSlot() {
+        used_[id_].store(false, std::memory_order_release);
+    }
+
+    static inline std::atomic<bool> used_[MAX_THREADS] = {};
+    int id_;
+};
+
+
+template<typename T, size_t SEGMENT_SIZE = 1024>
+class SegmentedMPMCQueue {
+public:
+    SegmentedMPMCQueue() {
+        Segment* segment = new Segment();
+        head_.store(segment);
+        tail_.store(segment);
+    }
+
+    SegmentedMPMCQueue(const SegmentedMPMCQueue&) = delete;
+    SegmentedMPMCQueue& operator=(const SegmentedMPMCQueue&) = delete;
+
+    // no other thread may use the queue at this point
+    ~SegmentedMPMCQueue() {
+        Segment* segment = head_.load();
+        while (segment) {
+            Segment* next = segment->next.load();
+            delete segment;
+            segment = next;
+        }
+        for (Segment* retired : retired_) {
+            delete retired;
+        }
+    }
+
+    bool TryPush(T value) {
+        Push(std::move(value));
+        return true;
+    }
+
+    // Every producer takes its own slot index with fetch_add. A consumer may
+    // mark the slot TAKEN before the producer publishes the value,
+    // then the producer just takes the next index.
+    void Push(T value) {
+        const int id = ThreadSlot::Id();
+        while (true) {
+            Segment* tail = Protect(tail_, id);
+            const size_t index = tail->enqueue_index.fetch_add(1);
+            if (index >= SEGMENT_SIZE) {
+                if (tail != tail_.load()) {
+                    continue;
+                }
+                Segment* next = tail->next.load();
+                if (next == nullptr) {
+                    Segment* segment = new Segment();
+                    segment->slots[0].value = std::move(value);
+                    segment->slots[0].state.store(READY, std::memory_order_relaxed);
+                    segment->enqueue_index.store(1, std::memory_order_relaxed);
+                    Segment* expected = nullptr;
+                    if (tail->next.compare_exchange_strong(expected, segment)) {
+                        tail_.compare_exchange_strong(tail, segment);
+                        hazards_[id].pointer.store(nullptr, std::memory_order_release);
+                        return;
+                    }
+                    value = std::move(segment->slots[0].value);
+                    delete segment;
+                } else {
+                    tail_.compare_exchange_strong(tail, next);
+                }
+                continue;
+            }
+            Slot& slot = tail->slots[index];
+            slot.value = std::move(value);
+            int8_t expected = EMPTY;
+            if (slot.state.compare_exchange_strong(expected, READY, std::memory_order_release)) {
+                hazards_[id].pointer.store(nullptr, std::memory_order_release);
+                return;
+            }
+            value = std::move(slot.value);
+        }
+    }
+
+    bool TryPop(T& value) {
+        const int id = ThreadSlot::Id();
+        while (true) {
+            Segment* head = Protect(head_, id);
+            if (head->dequeue_index.load() >= head->enqueue_index.load()
+                && head->next.load() == nullptr) {
+                break;
+            }
+            const size_t index = head->dequeue_index.fetch_add(1);
+            if (index >= SEGMENT_SIZE) {
+                Segment* next = head->next.load();
+                if (next == nullptr) {
+                    break;
+                }
+                // don't let the tail stay behind the head: retired segment
+                // must not be reachable from the queue
+                Segment* tail = head;
+                tail_.compare_exchange_strong(tail, next);
+                if (head_.compare_exchange_strong(head, next)) {
+                    hazards_[id].pointer.store(nullptr, std::memory_order_release);
+                    Retire(head);
+                }
+                continue;
+            }
+            Slot& slot = head->slots[index];
+            if (slot.state.exchange(TAKEN, std::memory_order_acquire) == READY) {
+                value = std::move(slot.value);
+                hazards_[id].pointer.store(nullptr, std::memory_order_release);
+                return true;
+            }
+        }
+        hazards_[id].pointer.store(nullptr, std::memory_order_release);
+        return false;
+    }
+
+    void Pop(T& value) {
+        while (!TryPop(value)) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    enum SlotState : int8_t {
+        EMPTY,
+        READY,
+        TAKEN
+    };
+
+    struct Slot {
+        std::atomic<int8_t> state{EMPTY};
+        T value;
+    };
+
+    struct Segment {
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueue_index{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeue_index{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<Segment*> next{nullptr};
+        Slot slots[SEGMENT_SIZE];
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Hazard {
+        std::atomic<Segment*> pointer{nullptr};
+    };
+
+    // hazard pointer: while it is set, nobody deletes the segment
+    Segment* Protect(const std::atomic<Segment*>& source, int id) {
+        Segment* segment = source.load();
+        while (true) {
+            hazards_[id].pointer.store(segment);
+            Segment* again = source.load();
+            if (again == segment) {
+                return segment;
+            }
+            segment = again;
+        }
+    }
+
+    // once per SEGMENT_SIZE items, so the mutex is not on the hot path
+    void Retire(Segment* segment) {
+        std::lock_guard guard(retired_mutex_);
+        retired_.push_back(segment);
+        std::vector<Segment*> still_used;
+        for (Segment* retired : retired_) {
+            bool is_used = false;
+            for (const Hazard& hazard : hazards_) {
+                if (hazard.pointer.load() == retired) {
+                    is_used = true;
+                    break;
+                }
+            }
+            if (is_used) {
+                still_used.push_back(retired);
+            } else {
+                delete retired;
+            }
+        }
+        retired_.swap(still_used);
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<Segment*> head_;
+    alignas(CACHE_LINE_SIZE) std::atomic<Segment*> tail_;
+    Hazard hazards_[ThreadSlot::MAX_THREADS];
+    std::mutex retired_mutex_;
+    std::vector<Segment*> retired_;
+};
+
+
+template<typename T>
+class BlockingQueue {
+public:
+    // capacity == 0 means unbounded
+    explicit BlockingQueue(size_t capacity = 0)
+        : capacity_(capacity)
+    {
+    }
+
+    bool TryPush(T value) {
+        {
+            std::lock_guard guard(mutex_);
+            if (capacity_ != 0 && items_.size() == capacity_) {
+                return false;
+            }
+            items_.push_back(std::move(value));
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool TryPop(T& value) {
+        {
+            std::lock_guard guard(mutex_);
+            if (items_.empty()) {
+                return false;
+            }
+            value = std::move(items_.front());
+            items_.pop_front();
+        }
+        not_full_.notify_one();
+        return true;
+    }
+
+    void Push(T value) {
+        {
+            std::unique_lock lock(mutex_);
+            not_full_.wait(lock, [this] { return capacity_ == 0 || items_.size() < capacity_; });
+            items_.push_back(std::move(value));
+        }
+        not_empty_.notify_one();
+    }
+
+    void Pop(T& value) {
+        {
+            std::unique_lock lock(mutex_);
+            not_empty_.wait(lock, [this] { return !items_.empty(); });
+            value = std::move(items_.front());
+            items_.pop_front();
+        }
+        not_full_.notify_one();
+    }
+
+private:
+    const size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+};
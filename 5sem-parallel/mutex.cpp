@@ -2,6 +2,7 @@
 #include <iostream>
 #include <vector>
 #include <mutex>
+#include "async_log.h"
 
 
 std::mutex mtx;
@@ -44,6 +45,15 @@ int print_with_mutex_exception_lock_guard(int m) {
     return 2 * m;
 }
 
+// No mutex at all: the line is formatted in this thread
+// and written to stdout by the logger thread.
+// Nothing stays locked after exception, lines are not mixed up
+int print_async_log(int m) {
+    if (m == 5) throw "Want hugs";
+    AsyncLog::Instance().WriteLine("got: ", m);
+    return 2 * m;
+}
+
 int main() {
     std::vector<std::future<int>> futures;
 
@@ -52,6 +62,7 @@ int main() {
         // futures.push_back(std::async(print_with_mutex, i));
         // futures.push_back(std::async(print_with_mutex_exception, i));
         futures.push_back(std::async(print_with_mutex_exception_lock_guard, i));
+        // futures.push_back(std::async(print_async_log, i));
     }
 
     for (auto& fut : futures) {
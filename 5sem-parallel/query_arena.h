@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Memory for the temporaries of one query (the words of SplitIntoWords, the
+// documents of Find): they live for microseconds, but every one of them is a
+// malloc + free, under a parallel policy - from all threads at once.
+//
+// QueryArena is a std::pmr::memory_resource that only moves a pointer:
+// deallocate does nothing, the memory comes back all at once by Rewind.
+// The blocks are kept, so after the first queries there are no mallocs at all;
+// when the arena is rewound to the beginning, several blocks are replaced by
+// one of their total size, so the next queries don't jump between blocks.
+//
+// ThreadQueryArena() - one arena per thread (thread_local, no locks), and
+// QueryArenaScope rewinds it at the end of the scope:
+//
+//   transform(execution::par, queries.begin(), queries.end(), counts.begin(), [](string_view query) {
+//       QueryArenaScope scope;
+//       return SplitIntoWords(query, scope.resource()).size();
+//   });
+//
+// The scope rewinds to the position where it started, not to zero, so scopes
+// may be nested (an element function that runs a parallel algorithm itself).
+// Nothing allocated in the scope may outlive it.
+//
+// Only for seq and par, not for par_unseq: under par_unseq the element
+// functions of one thread may be interleaved, scope A would rewind the arena
+// to its start and free the memory that the interleaved scope B still uses.
+//
+// Compared with std::pmr::monotonic_buffer_resource: the monotonic resource is
+// created per query, its release() gives the blocks back to upstream, so every
+// query larger than the initial buffer mallocs again.
+
+class QueryArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    struct Position {
+        size_t block = 0;
+        size_t offset = 0;
+    };
+
+    explicit QueryArena(size_t block_size = DEFAULT_BLOCK_SIZE)
+        : block_size_(block_size)
+    {
+    }
+
+    Position Tell() const {
+        return position_;
+    }
+
+    // everything allocated after `position` is free again
+    void Rewind(Position position) {
+        position_ = position;
+        if (position.block == 0 && position.offset == 0 && blocks_.size() > 1) {
+            size_t total_size = 0;
+            for (const Block& block : blocks_) {
+                total_size += block.size;
+            }
+            blocks_.clear();
+            AddBlock(total_size);
+        }
+    }
+
+    size_t Capacity() const {
+        size_t capacity = 0;
+        for (const Block& block : blocks_) {
+            capacity += block.size;
+        }
+        return capacity;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+    };
+
+    void AddBlock(size_t size) {
+        blocks_.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        while (true) {
+            if (position_.block < blocks_.size()) {
+                Block& block = blocks_[position_.block];
+                const uintptr_t begin = reinterpret_cast<uintptr_t>(block.data.get());
+                const uintptr_t aligned = (begin + position_.offset + alignment - 1) & ~(alignment - 1);
+                if (aligned + bytes <= begin + block.size) {
+                    position_.offset = aligned + bytes - begin;
+                    return reinterpret_cast<void*>(aligned);
+                }
+                if (position_.block + 1 < blocks_.size()) {
+                    position_ = {position_.block + 1, 0};
+                    continue;
+                }
+            }
+            // the blocks grow geometrically, a large allocation gets a block of its own size
+            const size_t last_size = blocks_.empty() ? block_size_ / 2 : blocks_.back().size;
+            AddBlock(std::max(2 * last_size, bytes + alignment));
+            position_ = {blocks_.size() - 1, 0};
+        }
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    size_t block_size_;
+    std::vector<Block> blocks_;
+    Position position_;
+};
+
+// the arena of the calling thread
+inline QueryArena& ThreadQueryArena() {
+    thread_local QueryArena arena;
+    return arena;
+}
+
+// the arena of the calling thread, rewound at the end of the scope
+class QueryArenaScope {
+public:
+    QueryArenaScope()
+        : arena_(ThreadQueryArena())
+        , start_(arena_.Tell())
+    {
+    }
+
+    QueryArenaScope(const QueryArenaScope&) = delete;
+    QueryArenaScope& operator=(const QueryArenaScope&) = delete;
+
+    ~QueryArenaScope() {
+        arena_.Rewind(start_);
+    }
+
+    std::pmr::memory_resource* resource() const {
+        return &arena_;
+    }
+
+private:
+    QueryArena& arena_;
+    QueryArena::Position start_;
+};
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mpmc_queue.h"
+
+using namespace std;
+
+// Producers push the time of the push, consumers pop it and remember
+// how long the item stayed in the queue.
+// usage: ./queue_bench [item_count]
+
+using Clock = chrono::steady_clock;
+
+constexpr size_t BOUNDED_CAPACITY = 1024;
+
+uint64_t NowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+struct RunResult {
+    double mops = 0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+};
+
+uint64_t Percentile(vector<uint64_t>& values, double p) {
+    const size_t k = min(values.size() - 1, static_cast<size_t>(values.size() * p));
+    nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+template<typename Queue>
+RunResult Run(Queue& queue, int thread_count, int item_count) {
+    vector<uint64_t> latencies;
+    latencies.reserve(item_count);
+    Clock::time_point start;
+    Clock::time_point finish;
+
+    if (thread_count == 1) {
+        // no contention at all: one thread pushes and pops by turns
+        start = Clock::now();
+        uint64_t pushed_at;
+        for (int i = 0; i < item_count; ++i) {
+            queue.Push(NowNs());
+            queue.Pop(pushed_at);
+            latencies.push_back(NowNs() - pushed_at);
+        }
+        finish = Clock::now();
+    } else {
+        const int producer_count = thread_count / 2;
+        const int consumer_count = thread_count - producer_count;
+        vector<vector<uint64_t>> consumer_latencies(consumer_count);
+        atomic<bool> go = false;
+
+        vector<thread> threads;
+        for (int p = 0; p < producer_count; ++p) {
+            const int count = item_count / producer_count + (p < item_count % producer_count);
+            threads.emplace_back([&queue, &go, count] {
+                while (!go.load()) {
+                    this_thread::yield();
+                }
+                for (int i = 0; i < count; ++i) {
+                    queue.Push(NowNs());
+                }
+            });
+        }
+        for (int c = 0; c < consumer_count; ++c) {
+            const int count = item_count / consumer_count + (c < item_count % consumer_count);
+            threads.emplace_back([&queue, &go, &local = consumer_latencies[c], count] {
+                local.reserve(count);
+                while (!go.load()) {
+                    this_thread::yield();
+                }
+                uint64_t pushed_at;
+                for (int i = 0; i < count; ++i) {
+                    queue.Pop(pushed_at);
+                    local.push_back(NowNs() - pushed_at);
+                }
+            });
+        }
+
+        start = Clock::now();
+        go.store(true);
+        for (thread& t : threads) {
+            t.join();
+        }
+        finish = Clock::now();
+
+        for (const auto& local : consumer_latencies) {
+            latencies.insert(latencies.end(), local.begin(), local.end());
+        }
+    }
+
+    RunResult result;
+    result.mops = item_count / chrono::duration<double, micro>(finish - start).count();
+    result.p50 = Percentile(latencies, 0.5);
+    result.p99 = Percentile(latencies, 0.99);
+    result.p999 = Percentile(latencies, 0.999);
+    return result;
+}
+
+template<typename MakeQueue>
+void Bench(const string& name, MakeQueue make_queue, int item_count) {
+    for (int thread_count = 1; thread_count <= 64; thread_count *= 2) {
+        auto queue = make_queue();
+        const RunResult result = Run(*queue, thread_count, item_count);
+        cout << left << setw(24) << name
+             << right << setw(8) << thread_count
+             << setw(12) << fixed << setprecision(2) << result.mops
+             << setw(12) << result.p50
+             << setw(12) << result.p99
+             << setw(12) << result.p999 << endl;
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    const int item_count = argc > 1 ? stoi(argv[1]) : 1 << 20;
+
+    cout << left << setw(24) << "queue"
+         << right << setw(8) << "threads"
+         << setw(12) << "Mops/s"
+         << setw(12) << "p50 ns"
+         << setw(12) << "p99 ns"
+         << setw(12) << "p99.9 ns" << endl;
+
+    Bench("mutex+condvar bounded", [] { return make_unique<BlockingQueue<uint64_t>>(BOUNDED_CAPACITY); }, item_count);
+    Bench("mutex+condvar", [] { return make_unique<BlockingQueue<uint64_t>>(); }, item_count);
+    Bench("lock-free bounded", [] { return make_unique<BoundedMPMCQueue<uint64_t>>(BOUNDED_CAPACITY); }, item_count);
+    Bench("lock-free segmented", [] { return make_unique<SegmentedMPMCQueue<uint64_t>>(); }, item_count);
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "profile.h"
+#include "rmq.h"
+#include "segment_tree.h"
+
+using namespace std;
+
+// RMQ structures against the recursive segment tree (contest 5):
+// build and a batch of random queries, half of them short (inside ~100 elements).
+// compile with -O2 -march=native -pthread
+// usage: ./rmq_bench [size] [query_count]
+
+vector<int> GenerateNumbers(mt19937& generator, int number_count, int max_value) {
+    vector<int> v(number_count);
+    for (int& value : v) {
+        value = uniform_int_distribution(-max_value, max_value)(generator);
+    }
+    return v;
+}
+
+vector<RangeQuery> GenerateQueries(mt19937& generator, int query_count, int size) {
+    vector<RangeQuery> queries(query_count);
+    for (RangeQuery& query : queries) {
+        const int length = uniform_int_distribution(0, 1)(generator) == 0
+            ? uniform_int_distribution(1, min(size, 100))(generator)
+            : uniform_int_distribution(1, size)(generator);
+        query.left = uniform_int_distribution(0, size - length)(generator);
+        query.right = query.left + length;
+    }
+    return queries;
+}
+
+template<typename Rmq>
+void Bench(const string& name, const vector<int>& values, const vector<RangeQuery>& queries, const vector<int>& expected) {
+    vector<int> answers;
+    {
+        LOG_DURATION(name + " build + queries");
+        optional<Rmq> rmq;
+        {
+            LOG_DURATION(name + " build");
+            rmq.emplace(values);
+        }
+        {
+            LOG_DURATION(name + " queries");
+            answers = AnswerQueries(*rmq, queries);
+        }
+        cerr << name << " memory: " << rmq->MemoryUsage() / (1 << 20) << " MB" << endl;
+    }
+    if (answers != expected) {
+        cout << "WRONG RESULT" << endl;
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    const int size = argc > 1 ? stoi(argv[1]) : 10'000'000;
+    const int query_count = argc > 2 ? stoi(argv[2]) : 10'000'000;
+    mt19937 generator;
+    const vector<int> values = GenerateNumbers(generator, size, 1'000'000'000);
+    const vector<RangeQuery> queries = GenerateQueries(generator, query_count, size);
+
+    vector<int> expected(queries.size());
+    {
+        LOG_DURATION("RecursiveSegmentTree build + queries");
+        const RecursiveSegmentTree<int> tree(values);
+        for (size_t i = 0; i < queries.size(); ++i) {
+            expected[i] = tree.Query(queries[i].left, queries[i].right);
+        }
+    }
+
+    Bench<BlockRmq>("BlockRmq", values, queries, expected);
+    Bench<SparseTable>("SparseTable", values, queries, expected);
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <execution>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef __SSE4_1__
+  #include <smmintrin.h>
+#endif
+
+// In-place inclusive scan: *it = op(*first, ..., *it).
+// op must be associative (not necessarily commutative).
+//
+//   InclusiveScan(execution::par, v.begin(), v.end(), plus<>{});
+//
+// With a parallel policy the range is split into blocks, one per thread:
+//   1. every block is reduced to its total (in parallel)
+//   2. totals are scanned, that gives the carry of every block (sequentially, few values)
+//   3. every block is scanned starting from its carry (in parallel)
+// So the data is read twice and written once.
+// For vector<int> with plus<> or MaxOp the block scan is done in SSE registers
+// (compile with -msse4.1 or -march=native).
+
+// op for a running maximum
+struct MaxOp {
+    template<typename T>
+    T operator()(const T& lhs, const T& rhs) const {
+        return std::max(lhs, rhs);
+    }
+};
+
+
+namespace ScanDetail {
+
+    constexpr size_t MIN_BLOCK_SIZE = 1 << 15;
+
+    template<typename It, typename Op, typename T>
+    void ScanBlockScalar(It first, It last, Op op, T carry, bool has_carry) {
+        if (first == last) {
+            return;
+        }
+        if (!has_carry) {
+            carry = *first;
+            ++first;
+        }
+        for (; first != last; ++first) {
+            carry = op(carry, *first);
+            *first = carry;
+        }
+    }
+
+#ifdef __SSE4_1__
+    // 4 ints in a register: log2(4) = 2 shift+op steps instead of 3 dependent ones,
+    // shifted-in lanes are filled with the identity of op
+    template<typename Op>
+    void ScanBlockSimd(int* data, size_t size, Op op, int carry, bool has_carry) {
+        constexpr bool is_plus = !std::is_same_v<Op, MaxOp>;
+        const __m128i identity = _mm_set1_epi32(is_plus ? 0 : INT_MIN);
+        const auto combine = [](__m128i lhs, __m128i rhs) {
+            if constexpr (is_plus) {
+                return _mm_add_epi32(lhs, rhs);
+            } else {
+                return _mm_max_epi32(lhs, rhs);
+            }
+        };
+
+        __m128i carry_vec = has_carry ? _mm_set1_epi32(carry) : identity;
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            x = combine(x, _mm_alignr_epi8(x, identity, 12));
+            x = combine(x, _mm_alignr_epi8(x, identity, 8));
+            x = combine(carry_vec, x);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), x);
+            carry_vec = _mm_shuffle_epi32(x, 0xFF);
+        }
+        if (i < size) {
+            ScanBlockScalar(data + i, data + size, op, _mm_cvtsi128_si32(carry_vec), has_carry || i > 0);
+        }
+    }
+#endif
+
+    template<typename It, typename Op>
+    constexpr bool HAS_SIMD_SCAN =
+#ifdef __SSE4_1__
+        (std::is_same_v<It, int*> || std::is_same_v<It, std::vector<int>::iterator>)
+        && (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<int>> || std::is_same_v<Op, MaxOp>);
+#else
+        false;
+#endif
+
+    template<typename It, typename Op, typename T>
+    void ScanBlock(It first, It last, Op op, T carry, bool has_carry) {
+        if constexpr (HAS_SIMD_SCAN<It, Op>) {
+            ScanBlockSimd(&*first, last - first, op, carry, has_carry);
+        } else {
+            ScanBlockScalar(first, last, op, carry, has_carry);
+        }
+    }
+
+}
+
+
+template<typename ExecutionPolicy, typename It, typename Op>
+It InclusiveScan(ExecutionPolicy&& policy, It first, It last, Op op) {
+    (void) policy;
+    using T = typename std::iterator_traits<It>::value_type;
+    using ScanDetail::MIN_BLOCK_SIZE;
+
+    const size_t size = std::distance(first, last);
+    constexpr bool is_sequenced = std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>;
+    const size_t block_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), size / MIN_BLOCK_SIZE);
+
+    if (is_sequenced || block_count < 2) {
+        ScanDetail::ScanBlock(first, last, op, T{}, false);
+        return last;
+    }
+
+    std::vector<It> bounds(block_count + 1);
+    for (size_t i = 0; i <= block_count; ++i) {
+        bounds[i] = std::next(first, size * i / block_count);
+    }
+
+    // the last block's total is never needed
+    std::vector<std::future<T>> totals;
+    for (size_t i = 0; i + 1 < block_count; ++i) {
+        totals.push_back(std::async(std::launch::async, [op, begin = bounds[i], end = bounds[i + 1]] {
+            return std::accumulate(std::next(begin), end, *begin, op);
+        }));
+    }
+
+    std::vector<T> carries(block_count);
+    carries[1] = totals[0].get();
+    for (size_t i = 2; i < block_count; ++i) {
+        carries[i] = op(carries[i - 1], totals[i - 1].get());
+    }
+
+    std::vector<std::future<void>> scans;
+    for (size_t i = 1; i < block_count; ++i) {
+        scans.push_back(std::async(std::launch::async, [op, begin = bounds[i], end = bounds[i + 1], carry = carries[i]] {
+            ScanDetail::ScanBlock(begin, end, op, carry, true);
+        }));
+    }
+    ScanDetail::ScanBlock(bounds[0], bounds[1], op, T{}, false);
+    for (auto& scan : scans) {
+        scan.get();
+    }
+    return last;
+}
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "profile.h"
+#include "scan.h"
+
+using namespace std;
+
+// compile with -march=native to get the SIMD block scan
+
+vector<int> GenerateNumbers(mt19937& generator, int number_count, int max_value) {
+    vector<int> v(number_count);
+    for (int& value : v) {
+        value = uniform_int_distribution(-max_value, max_value)(generator);
+    }
+    return v;
+}
+
+template<typename Op>
+void Bench(const string& name, const vector<int>& v, Op op) {
+    vector<int> expected = v;
+    {
+        LOG_DURATION(name + " partial_sum");
+        partial_sum(expected.begin(), expected.end(), expected.begin(), op);
+    }
+
+    const auto check = [&expected](const vector<int>& result) {
+        if (result != expected) {
+            cout << "WRONG RESULT" << endl;
+        }
+    };
+
+    {
+        vector<int> result = v;
+        {
+            LOG_DURATION(name + " std::inclusive_scan seq");
+            inclusive_scan(execution::seq, result.begin(), result.end(), result.begin(), op);
+        }
+        check(result);
+    }
+    {
+        vector<int> result = v;
+        {
+            LOG_DURATION(name + " std::inclusive_scan par");
+            inclusive_scan(execution::par, result.begin(), result.end(), result.begin(), op);
+        }
+        check(result);
+    }
+    {
+        vector<int> result = v;
+        {
+            LOG_DURATION(name + " InclusiveScan seq");
+            InclusiveScan(execution::seq, result.begin(), result.end(), op);
+        }
+        check(result);
+    }
+    {
+        vector<int> result = v;
+        {
+            LOG_DURATION(name + " InclusiveScan par");
+            InclusiveScan(execution::par, result.begin(), result.end(), op);
+        }
+        check(result);
+    }
+}
+
+int main() {
+    mt19937 generator;
+    // small values so that the sum doesn't overflow
+    const vector<int> v = GenerateNumbers(generator, 100'000'000, 10);
+
+    Bench("sum", v, plus<>{});
+    Bench("max", v, MaxOp{});
+}
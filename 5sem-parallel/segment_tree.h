@@ -0,0 +1,395 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "workload.h"
+
+#ifdef __AVX2__
+  #include <immintrin.h>
+#endif
+
+// Monoid: an associative operation with an identity element,
+// everything a segment tree needs from the operation.
+template<typename T>
+struct MinMonoid {
+    static constexpr T IDENTITY = std::numeric_limits<T>::max();
+
+    T operator()(const T& lhs, const T& rhs) const {
+        return std::min(lhs, rhs);
+    }
+};
+
+template<typename T>
+struct SumMonoid {
+    static constexpr T IDENTITY = T{};
+
+    T operator()(const T& lhs, const T& rhs) const {
+        return lhs + rhs;
+    }
+};
+
+
+// The standard segment tree from the lectures: node v has children 2v and 2v + 1,
+// 4n nodes, build, query and update are recursive from the root.
+// It's the reference the other RMQ structures are compared with.
+// Queries are on half-open ranges [left, right).
+template<typename T, typename Monoid = MinMonoid<T>>
+class RecursiveSegmentTree {
+public:
+    explicit RecursiveSegmentTree(const std::vector<T>& values)
+        : size_(values.size())
+        , tree_(4 * std::max<size_t>(1, values.size()), Monoid::IDENTITY)
+    {
+        if (size_ != 0) {
+            Build(values, 1, 0, size_);
+        }
+    }
+
+    T Query(size_t left, size_t right) const {
+        return Query(1, 0, size_, left, right);
+    }
+
+    void Update(size_t position, const T& value) {
+        Update(1, 0, size_, position, value);
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+private:
+    void Build(const std::vector<T>& values, size_t v, size_t left, size_t right) {
+        if (right - left == 1) {
+            tree_[v] = values[left];
+            return;
+        }
+        const size_t middle = (left + right) / 2;
+        Build(values, 2 * v, left, middle);
+        Build(values, 2 * v + 1, middle, right);
+        tree_[v] = op_(tree_[2 * v], tree_[2 * v + 1]);
+    }
+
+    T Query(size_t v, size_t left, size_t right, size_t query_left, size_t query_right) const {
+        if (query_right <= left || right <= query_left) {
+            return Monoid::IDENTITY;
+        }
+        if (query_left <= left && right <= query_right) {
+            return tree_[v];
+        }
+        const size_t middle = (left + right) / 2;
+        return op_(Query(2 * v, left, middle, query_left, query_right),
+                   Query(2 * v + 1, middle, right, query_left, query_right));
+    }
+
+    void Update(size_t v, size_t left, size_t right, size_t position, const T& value) {
+        if (right - left == 1) {
+            tree_[v] = value;
+            return;
+        }
+        const size_t middle = (left + right) / 2;
+        if (position < middle) {
+            Update(2 * v, left, middle, position, value);
+        } else {
+            Update(2 * v + 1, middle, right, position, value);
+        }
+        tree_[v] = op_(tree_[2 * v], tree_[2 * v + 1]);
+    }
+
+    size_t size_;
+    std::vector<T> tree_;
+    Monoid op_;
+};
+
+
+template<typename T>
+struct PointUpdate {
+    size_t position;
+    T value;
+};
+
+namespace SegmentTreeDetail {
+
+    inline void Mark(std::vector<uint64_t>& bits, size_t i) {
+        bits[i / 64] |= uint64_t{1} << (i % 64);
+    }
+
+}
+
+
+// Non-recursive segment tree on 2n elements: leaves are tree_[n, 2n), node v
+// has children 2v and 2v + 1, the root is 1. Works for any n, not only powers
+// of two (some inner nodes then mix the ends of the array, they are never used
+// by queries). The left and the right results of a query are kept apart, so
+// the monoid doesn't have to be commutative.
+//
+// Build: nodes [2^k, 2^(k+1)) depend only on the nodes below them, so the tree
+// is built level by level, every level in parallel.
+// Batched update: the leaves are written first and their parents are marked in
+// a bitmap of dirty nodes, then the bitmap is scanned from the highest node to
+// the lowest. That's sorted order without sorting: the children of v are 2v and
+// 2v + 1, so they are recomputed before v, and a common ancestor of many
+// updates is recomputed once instead of once per update.
+template<typename T, typename Monoid = MinMonoid<T>>
+class BottomUpSegmentTree {
+public:
+    explicit BottomUpSegmentTree(const std::vector<T>& values)
+        : size_(values.size())
+        , tree_(2 * values.size(), Monoid::IDENTITY)
+    {
+        std::copy(values.begin(), values.end(), tree_.begin() + size_);
+        for (size_t first = size_ > 1 ? size_t{1} << (63 - __builtin_clzll(size_ - 1)) : 0; first > 0; first /= 2) {
+            const size_t last = std::min(2 * first, size_);
+            ParallelFor(last - first, [&](size_t, size_t begin, size_t end) {
+                for (size_t v = first + begin; v < first + end; ++v) {
+                    tree_[v] = op_(tree_[2 * v], tree_[2 * v + 1]);
+                }
+            });
+        }
+    }
+
+    T Query(size_t left, size_t right) const {
+        T left_result = Monoid::IDENTITY;
+        T right_result = Monoid::IDENTITY;
+        for (left += size_, right += size_; left < right; left /= 2, right /= 2) {
+            if (left & 1) {
+                left_result = op_(left_result, tree_[left++]);
+            }
+            if (right & 1) {
+                right_result = op_(tree_[--right], right_result);
+            }
+        }
+        return op_(left_result, right_result);
+    }
+
+    void Update(size_t position, const T& value) {
+        size_t v = position + size_;
+        tree_[v] = value;
+        for (v /= 2; v > 0; v /= 2) {
+            tree_[v] = op_(tree_[2 * v], tree_[2 * v + 1]);
+        }
+    }
+
+    // of several updates of one position the last one wins
+    void Update(const std::vector<PointUpdate<T>>& updates) {
+        std::vector<uint64_t> dirty(size_ / 64 + 1);
+        for (const PointUpdate<T>& update : updates) {
+            const size_t v = update.position + size_;
+            tree_[v] = update.value;
+            if (v > 1) {
+                SegmentTreeDetail::Mark(dirty, v / 2);
+            }
+        }
+        // highest dirty node first; its parent is lower, so it is found later in the same pass
+        for (size_t word = dirty.size(); word-- > 0;) {
+            while (dirty[word] != 0) {
+                const size_t v = word * 64 + 63 - __builtin_clzll(dirty[word]);
+                dirty[word] &= ~(uint64_t{1} << (v % 64));
+                tree_[v] = op_(tree_[2 * v], tree_[2 * v + 1]);
+                if (v > 1) {
+                    SegmentTreeDetail::Mark(dirty, v / 2);
+                }
+            }
+        }
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    size_t MemoryUsage() const {
+        return tree_.size() * sizeof(T);
+    }
+
+private:
+    size_t size_;
+    std::vector<T> tree_;
+    Monoid op_;
+};
+
+
+// Fold of node[from, to) of a node of B elements. Generic version is a loop,
+// for MinMonoid<int> and SumMonoid<int64_t> with B = 16 it is done in AVX2
+// registers without branches: the whole node is loaded, the lanes outside
+// [from, to) are replaced by the identity.
+template<typename T, typename Monoid, size_t B>
+struct NodeFold {
+    static T Apply(const T* node, size_t from, size_t to) {
+        const Monoid op;
+        T result = Monoid::IDENTITY;
+        for (size_t i = from; i < to; ++i) {
+            result = op(result, node[i]);
+        }
+        return result;
+    }
+};
+
+#ifdef __AVX2__
+template<>
+struct NodeFold<int, MinMonoid<int>, 16> {
+    static int Apply(const int* node, size_t from, size_t to) {
+        const __m256i first = _mm256_set1_epi32(from);
+        const __m256i last = _mm256_set1_epi32(to);
+        const __m256i identity = _mm256_set1_epi32(MinMonoid<int>::IDENTITY);
+        __m256i x = identity;
+        for (int offset = 0; offset < 16; offset += 8) {
+            const __m256i lanes = _mm256_setr_epi32(offset, offset + 1, offset + 2, offset + 3,
+                                                    offset + 4, offset + 5, offset + 6, offset + 7);
+            // from <= lane < to
+            const __m256i inside = _mm256_andnot_si256(_mm256_cmpgt_epi32(first, lanes), _mm256_cmpgt_epi32(last, lanes));
+            const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(node + offset));
+            x = _mm256_min_epi32(x, _mm256_blendv_epi8(identity, values, inside));
+        }
+        __m128i y = _mm_min_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+        y = _mm_min_epi32(y, _mm_shuffle_epi32(y, 0x4E));
+        y = _mm_min_epi32(y, _mm_shuffle_epi32(y, 0xB1));
+        return _mm_cvtsi128_si32(y);
+    }
+};
+
+template<>
+struct NodeFold<int64_t, SumMonoid<int64_t>, 16> {
+    static int64_t Apply(const int64_t* node, size_t from, size_t to) {
+        const __m256i first = _mm256_set1_epi64x(from);
+        const __m256i last = _mm256_set1_epi64x(to);
+        __m256i x = _mm256_setzero_si256();
+        for (int offset = 0; offset < 16; offset += 4) {
+            const __m256i lanes = _mm256_setr_epi64x(offset, offset + 1, offset + 2, offset + 3);
+            const __m256i inside = _mm256_andnot_si256(_mm256_cmpgt_epi64(first, lanes), _mm256_cmpgt_epi64(last, lanes));
+            const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(node + offset));
+            x = _mm256_add_epi64(x, _mm256_and_si256(values, inside));
+        }
+        __m128i y = _mm_add_epi64(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+        y = _mm_add_epi64(y, _mm_unpackhi_epi64(y, y));
+        return _mm_cvtsi128_si64(y);
+    }
+};
+#endif
+
+
+// B-ary segment tree ("S-tree" layout): every level is an array padded to a
+// multiple of B, element i of level k + 1 is the fold of the node
+// [iB, iB + B) of level k. A node of 16 ints is one cache line, the height is
+// log_B n (7 levels for 10^8 and B = 16 instead of 27), and a node is folded by
+// NodeFold in a few vector instructions.
+//
+// Query: on every level the partial nodes at both ends are folded into the left
+// and the right result, then the range moves one level up. Update recomputes
+// one node per level. Batched update marks the changed nodes in a bitmap per
+// level and recomputes each of them once, in index order; the nodes of one
+// level don't depend on each other, so a level is recomputed in parallel.
+// Build is parallel too.
+template<typename T, typename Monoid = MinMonoid<T>, size_t B = 16>
+class WideSegmentTree {
+public:
+    explicit WideSegmentTree(const std::vector<T>& values)
+        : size_(values.size())
+    {
+        levels_.emplace_back(RoundUp(std::max<size_t>(1, size_)), Monoid::IDENTITY);
+        std::copy(values.begin(), values.end(), levels_[0].begin());
+        while (levels_.back().size() > B) {
+            const std::vector<T>& previous = levels_.back();
+            std::vector<T> level(RoundUp(previous.size() / B), Monoid::IDENTITY);
+            ParallelFor(previous.size() / B, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    level[i] = Fold(&previous[i * B], 0, B);
+                }
+            });
+            levels_.push_back(std::move(level));
+        }
+    }
+
+    T Query(size_t left, size_t right) const {
+        T left_result = Monoid::IDENTITY;
+        T right_result = Monoid::IDENTITY;
+        for (const std::vector<T>& level : levels_) {
+            if (left >= right) {
+                break;
+            }
+            const size_t left_node = left / B;
+            const size_t right_node = (right - 1) / B;
+            if (left_node == right_node) {
+                const T middle = Fold(&level[left_node * B], left % B, right - left_node * B);
+                return op_(op_(left_result, middle), right_result);
+            }
+            left_result = op_(left_result, Fold(&level[left_node * B], left % B, B));
+            right_result = op_(Fold(&level[right_node * B], 0, right - right_node * B), right_result);
+            left = left_node + 1;
+            right = right_node;
+        }
+        return op_(left_result, right_result);
+    }
+
+    void Update(size_t position, const T& value) {
+        levels_[0][position] = value;
+        for (size_t k = 1; k < levels_.size(); ++k) {
+            position /= B;
+            levels_[k][position] = Fold(&levels_[k - 1][position * B], 0, B);
+        }
+    }
+
+    // of several updates of one position the last one wins
+    void Update(const std::vector<PointUpdate<T>>& updates) {
+        for (const PointUpdate<T>& update : updates) {
+            levels_[0][update.position] = update.value;
+        }
+        if (levels_.size() == 1) {
+            return;
+        }
+        std::vector<uint64_t> dirty(WordCount(levels_[1].size()));
+        for (const PointUpdate<T>& update : updates) {
+            SegmentTreeDetail::Mark(dirty, update.position / B);
+        }
+        for (size_t k = 1; k < levels_.size(); ++k) {
+            const std::vector<T>& below = levels_[k - 1];
+            std::vector<T>& level = levels_[k];
+            // the nodes of parent word p are in the words [pB, pB + B) of this level,
+            // so every thread sets bits only in its own parent words
+            std::vector<uint64_t> parents((dirty.size() + B - 1) / B);
+            ParallelFor(parents.size(), [&](size_t, size_t begin, size_t end) {
+                for (size_t parent_word = begin; parent_word < end; ++parent_word) {
+                    const size_t last_word = std::min(dirty.size(), (parent_word + 1) * B);
+                    for (size_t word = parent_word * B; word < last_word; ++word) {
+                        for (uint64_t bits = dirty[word]; bits != 0; bits &= bits - 1) {
+                            const size_t node = word * 64 + __builtin_ctzll(bits);
+                            level[node] = Fold(&below[node * B], 0, B);
+                            parents[parent_word] |= uint64_t{1} << (node / B % 64);
+                        }
+                    }
+                }
+            });
+            dirty = std::move(parents);
+        }
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    size_t MemoryUsage() const {
+        size_t usage = 0;
+        for (const auto& level : levels_) {
+            usage += level.size() * sizeof(T);
+        }
+        return usage;
+    }
+
+private:
+    static size_t RoundUp(size_t size) {
+        return (size + B - 1) / B * B;
+    }
+
+    static size_t WordCount(size_t bit_count) {
+        return (bit_count + 63) / 64;
+    }
+
+    static T Fold(const T* node, size_t from, size_t to) {
+        return NodeFold<T, Monoid, B>::Apply(node, from, to);
+    }
+
+    size_t size_;
+    std::vector<std::vector<T>> levels_;
+    Monoid op_;
+};
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "profile.h"
+#include "rmq.h"
+#include "segment_tree.h"
+
+using namespace std;
+
+// Segment trees with updates against the recursive one: build, random queries,
+// the same random point updates one by one and as one batch.
+// Queries and single updates are run in one thread: the point is the layout,
+// not the number of cores. Builds and big batches use all of them.
+// compile with -O2 -march=native -pthread
+// usage: ./segment_tree_bench [size] [operation_count]   (10^7 by default, 10^8 needs ~3 GB)
+
+constexpr size_t CHECK_QUERY_COUNT = 1'000'000;
+
+vector<int> GenerateNumbers(mt19937& generator, size_t number_count, int max_value) {
+    vector<int> v(number_count);
+    for (int& value : v) {
+        value = uniform_int_distribution(-max_value, max_value)(generator);
+    }
+    return v;
+}
+
+vector<RangeQuery> GenerateQueries(mt19937& generator, size_t query_count, size_t size) {
+    vector<RangeQuery> queries(query_count);
+    for (RangeQuery& query : queries) {
+        const size_t length = uniform_int_distribution<size_t>(1, size)(generator);
+        query.left = uniform_int_distribution<size_t>(0, size - length)(generator);
+        query.right = query.left + length;
+    }
+    return queries;
+}
+
+vector<PointUpdate<int>> GenerateUpdates(mt19937& generator, size_t update_count, size_t size, int max_value) {
+    vector<PointUpdate<int>> updates(update_count);
+    for (PointUpdate<int>& update : updates) {
+        update.position = uniform_int_distribution<size_t>(0, size - 1)(generator);
+        update.value = uniform_int_distribution(-max_value, max_value)(generator);
+    }
+    return updates;
+}
+
+template<typename Tree>
+vector<int> RunQueries(const Tree& tree, const vector<RangeQuery>& queries, size_t count) {
+    vector<int> answers(min(count, queries.size()));
+    for (size_t i = 0; i < answers.size(); ++i) {
+        answers[i] = tree.Query(queries[i].left, queries[i].right);
+    }
+    return answers;
+}
+
+struct Expected {
+    vector<int> before;
+    vector<int> after;
+};
+
+template<typename Tree>
+void Bench(const string& name, const vector<int>& values, const vector<RangeQuery>& queries,
+           const vector<PointUpdate<int>>& updates, const Expected& expected) {
+    optional<Tree> tree;
+    {
+        LOG_DURATION(name + " build");
+        tree.emplace(values);
+    }
+    cerr << name << " memory: " << tree->MemoryUsage() / (1 << 20) << " MB" << endl;
+    {
+        LOG_DURATION(name + " queries");
+        if (RunQueries(*tree, queries, queries.size()) != expected.before) {
+            cout << "WRONG RESULT" << endl;
+        }
+    }
+    {
+        LOG_DURATION(name + " updates one by one");
+        for (const PointUpdate<int>& update : updates) {
+            tree->Update(update.position, update.value);
+        }
+    }
+    if (RunQueries(*tree, queries, CHECK_QUERY_COUNT) != expected.after) {
+        cout << "WRONG RESULT" << endl;
+    }
+
+    tree.emplace(values);
+    {
+        LOG_DURATION(name + " batched updates");
+        tree->Update(updates);
+    }
+    if (RunQueries(*tree, queries, CHECK_QUERY_COUNT) != expected.after) {
+        cout << "WRONG RESULT" << endl;
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    const size_t size = argc > 1 ? stoull(argv[1]) : 10'000'000;
+    const size_t operation_count = argc > 2 ? stoull(argv[2]) : 10'000'000;
+    mt19937 generator;
+    const vector<int> values = GenerateNumbers(generator, size, 1'000'000'000);
+    const vector<RangeQuery> queries = GenerateQueries(generator, operation_count, size);
+    const vector<PointUpdate<int>> updates = GenerateUpdates(generator, operation_count, size, 1'000'000'000);
+
+    Expected expected;
+    {
+        optional<RecursiveSegmentTree<int>> tree;
+        {
+            LOG_DURATION("RecursiveSegmentTree build");
+            tree.emplace(values);
+        }
+        {
+            LOG_DURATION("RecursiveSegmentTree queries");
+            expected.before = RunQueries(*tree, queries, queries.size());
+        }
+        {
+            LOG_DURATION("RecursiveSegmentTree updates one by one");
+            for (const PointUpdate<int>& update : updates) {
+                tree->Update(update.position, update.value);
+            }
+        }
+        expected.after = RunQueries(*tree, queries, CHECK_QUERY_COUNT);
+    }
+
+    Bench<BottomUpSegmentTree<int>>("BottomUpSegmentTree", values, queries, updates, expected);
+    Bench<WideSegmentTree<int>>("WideSegmentTree", values, queries, updates, expected);
+}
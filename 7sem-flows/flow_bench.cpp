@@ -0,0 +1,144 @@
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "flow_graph.h"
+#include "matching.h"
+#include "max_flow.h"
+#include "profile.h"
+
+using namespace std;
+
+// Max flow and matching algorithms against the seminar ones (DFS Ford-Fulkerson, Kuhn)
+// on random graphs:
+// - bipartite graphs with `degree` random neighbours of every left vertex,
+//   as is and as a unit network source -> left -> right -> sink;
+// - layered networks: `width` vertices in a layer, every vertex has `degree`
+//   arcs with capacities 1..1000 to random vertices of the next layer.
+// The seminar algorithms are O(VE) and get only the small graphs.
+// usage: ./flow_bench [left_vertices] [degree]   (10^6 and 4 by default)
+
+constexpr uint32_t BASELINE_LIMIT = 10'000;
+
+vector<pair<uint32_t, uint32_t>> GenerateBipartite(mt19937& generator, uint32_t side, uint32_t degree) {
+    vector<pair<uint32_t, uint32_t>> edges;
+    edges.reserve(static_cast<size_t>(side) * degree);
+    for (uint32_t u = 0; u < side; ++u) {
+        for (uint32_t i = 0; i < degree; ++i) {
+            edges.emplace_back(u, uniform_int_distribution<uint32_t>(0, side - 1)(generator));
+        }
+    }
+    return edges;
+}
+
+// source = side * 2, sink = side * 2 + 1
+FlowGraph MatchingNetwork(uint32_t side, const vector<pair<uint32_t, uint32_t>>& edges) {
+    vector<FlowEdge> arcs;
+    arcs.reserve(edges.size() + 2 * side);
+    for (uint32_t u = 0; u < side; ++u) {
+        arcs.push_back({2 * side, u, 1});
+        arcs.push_back({side + u, 2 * side + 1, 1});
+    }
+    for (const auto& [u, v] : edges) {
+        arcs.push_back({u, side + v, 1});
+    }
+    return FlowGraph(2 * side + 2, arcs);
+}
+
+// source = 0, sink = 1, then the layers
+FlowGraph LayeredNetwork(mt19937& generator, uint32_t width, uint32_t layers, uint32_t degree) {
+    vector<FlowEdge> arcs;
+    const uint32_t vertex_count = 2 + width * layers;
+    for (uint32_t i = 0; i < width; ++i) {
+        arcs.push_back({0, 2 + i, 1'000'000});
+        arcs.push_back({2 + (layers - 1) * width + i, 1, 1'000'000});
+    }
+    for (uint32_t layer = 0; layer + 1 < layers; ++layer) {
+        for (uint32_t i = 0; i < width; ++i) {
+            for (uint32_t j = 0; j < degree; ++j) {
+                const uint32_t to = uniform_int_distribution<uint32_t>(0, width - 1)(generator);
+                arcs.push_back({2 + layer * width + i, 2 + (layer + 1) * width + to,
+                                uniform_int_distribution<int64_t>(1, 1000)(generator)});
+            }
+        }
+    }
+    return FlowGraph(vertex_count, arcs);
+}
+
+using MaxFlowFunction = function<int64_t(FlowGraph&, uint32_t, uint32_t)>;
+
+int64_t BenchFlow(const string& title, FlowGraph& graph, uint32_t source, uint32_t sink, bool with_baseline) {
+    cerr << title << ": " << graph.VertexCount() << " vertices, " << graph.ArcCount() / 2 << " edges, "
+         << graph.MemoryUsage() / (1 << 20) << " MB" << endl;
+    vector<pair<string, MaxFlowFunction>> algorithms = {
+        {"DinicMaxFlow", DinicMaxFlow},
+        {"PushRelabelMaxFlow", PushRelabelMaxFlow},
+    };
+    if (with_baseline) {
+        algorithms.emplace_back("FordFulkersonMaxFlow", FordFulkersonMaxFlow);
+    }
+    int64_t expected = -1;
+    for (const auto& [name, algorithm] : algorithms) {
+        graph.Reset();
+        int64_t flow;
+        {
+            LOG_DURATION("  " + name);
+            flow = algorithm(graph, source, sink);
+        }
+        if (expected != -1 && flow != expected) {
+            cout << "WRONG RESULT" << endl;
+        }
+        expected = flow;
+    }
+    cerr << "  flow " << expected << endl;
+    return expected;
+}
+
+void BenchMatching(mt19937& generator, uint32_t side, uint32_t degree) {
+    const auto edges = GenerateBipartite(generator, side, degree);
+    const BipartiteGraph graph(side, side, edges);
+    const bool with_baseline = side <= BASELINE_LIMIT;
+    cerr << "bipartite: " << side << " + " << side << " vertices, " << edges.size() << " edges" << endl;
+    Matching fast;
+    {
+        LOG_DURATION("  HopcroftKarpMatching");
+        fast = HopcroftKarpMatching(graph);
+    }
+    if (with_baseline) {
+        Matching slow;
+        {
+            LOG_DURATION("  KuhnMatching");
+            slow = KuhnMatching(graph);
+        }
+        if (slow.size != fast.size) {
+            cout << "WRONG RESULT" << endl;
+        }
+    }
+    cerr << "  matching " << fast.size << endl;
+
+    FlowGraph network = MatchingNetwork(side, edges);
+    if (BenchFlow("matching as flow", network, 2 * side, 2 * side + 1, with_baseline) != static_cast<int64_t>(fast.size)) {
+        cout << "WRONG RESULT" << endl;
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    const uint32_t side = argc > 1 ? stoul(argv[1]) : 1'000'000;
+    const uint32_t degree = argc > 2 ? stoul(argv[2]) : 4;
+    mt19937 generator;
+
+    vector<uint32_t> sizes = {min(side, BASELINE_LIMIT)};
+    if (side > BASELINE_LIMIT) {
+        sizes.push_back(side);
+    }
+    for (const uint32_t size : sizes) {
+        BenchMatching(generator, size, degree);
+        const uint32_t width = max<uint32_t>(1, size / 100);
+        FlowGraph layered = LayeredNetwork(generator, width, 100, degree);
+        BenchFlow("layered", layered, 0, 1, size <= BASELINE_LIMIT);
+        cerr << endl;
+    }
+}
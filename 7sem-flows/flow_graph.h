@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Directed graph with capacities for max flow algorithms, in CSR layout
+// (compressed sparse row): the arcs of vertex v are [Begin(v), End(v)) of flat
+// arrays, no vector per vertex. Every input edge u -> v gives two arcs:
+// u -> v with its capacity and the reverse v -> u with 0; Reverse(a) is the
+// index of the pair, so a push along an arc is two array writes.
+//
+// The residual capacities are the state of the algorithms; Reset() restores
+// the original ones, so one graph can be used by several algorithms in turn.
+
+struct FlowEdge {
+    uint32_t from;
+    uint32_t to;
+    int64_t capacity;
+};
+
+class FlowGraph {
+public:
+    FlowGraph(uint32_t vertex_count, const std::vector<FlowEdge>& edges)
+        : offsets_(vertex_count + 1, 0)
+        , head_(2 * edges.size())
+        , reverse_(2 * edges.size())
+        , capacity_(2 * edges.size())
+        , edge_arc_(edges.size())
+    {
+        // counting sort of the arcs by their tail
+        for (const FlowEdge& edge : edges) {
+            ++offsets_[edge.from + 1];
+            ++offsets_[edge.to + 1];
+        }
+        for (uint32_t v = 0; v < vertex_count; ++v) {
+            offsets_[v + 1] += offsets_[v];
+        }
+        std::vector<uint32_t> next(offsets_.begin(), offsets_.end() - 1);
+        for (size_t i = 0; i < edges.size(); ++i) {
+            const FlowEdge& edge = edges[i];
+            const uint32_t forward = next[edge.from]++;
+            const uint32_t backward = next[edge.to]++;
+            head_[forward] = edge.to;
+            head_[backward] = edge.from;
+            reverse_[forward] = backward;
+            reverse_[backward] = forward;
+            capacity_[forward] = edge.capacity;
+            capacity_[backward] = 0;
+            edge_arc_[i] = forward;
+        }
+        residual_ = capacity_;
+    }
+
+    uint32_t VertexCount() const {
+        return offsets_.size() - 1;
+    }
+
+    uint32_t ArcCount() const {
+        return head_.size();
+    }
+
+    uint32_t Begin(uint32_t v) const {
+        return offsets_[v];
+    }
+
+    uint32_t End(uint32_t v) const {
+        return offsets_[v + 1];
+    }
+
+    uint32_t Head(uint32_t arc) const {
+        return head_[arc];
+    }
+
+    uint32_t Reverse(uint32_t arc) const {
+        return reverse_[arc];
+    }
+
+    int64_t Residual(uint32_t arc) const {
+        return residual_[arc];
+    }
+
+    void Push(uint32_t arc, int64_t flow) {
+        residual_[arc] -= flow;
+        residual_[reverse_[arc]] += flow;
+    }
+
+    // flow along the i-th input edge
+    int64_t Flow(size_t edge) const {
+        const uint32_t arc = edge_arc_[edge];
+        return capacity_[arc] - residual_[arc];
+    }
+
+    void Reset() {
+        residual_ = capacity_;
+    }
+
+    size_t MemoryUsage() const {
+        return (offsets_.size() + head_.size() + reverse_.size() + edge_arc_.size()) * sizeof(uint32_t)
+            + (capacity_.size() + residual_.size()) * sizeof(int64_t);
+    }
+
+private:
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> head_;
+    std::vector<uint32_t> reverse_;
+    std::vector<int64_t> capacity_;
+    std::vector<int64_t> residual_;
+    std::vector<uint32_t> edge_arc_;
+};
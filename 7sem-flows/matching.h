@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Maximum matching in a bipartite graph; the neighbours of left vertex u are
+// [Begin(u), End(u)) of one flat array (CSR).
+//
+// KuhnMatching - the seminar algorithm: for every left vertex, look for an
+// augmenting path by DFS, visited marks are reset for every vertex. O(VE).
+//
+// HopcroftKarpMatching - phases: BFS from all free left vertices gives layers,
+// then vertex-disjoint shortest augmenting paths are found by DFS along the
+// layers, all in one phase. Current arc as in Dinic: an arc that failed in the
+// phase is not tried again, a vertex that failed is removed from the layers.
+// O(E sqrt V). Starts from a greedy matching.
+//
+// Both DFS are iterative: an augmenting path can have millions of vertices.
+
+struct Matching {
+    static constexpr uint32_t UNMATCHED = UINT32_MAX;
+
+    std::vector<uint32_t> left;
+    std::vector<uint32_t> right;
+    size_t size = 0;
+};
+
+class BipartiteGraph {
+public:
+    // edges are (left, right) pairs
+    BipartiteGraph(uint32_t left_count, uint32_t right_count, const std::vector<std::pair<uint32_t, uint32_t>>& edges)
+        : right_count_(right_count)
+        , offsets_(left_count + 1, 0)
+        , neighbours_(edges.size())
+    {
+        for (const auto& [u, v] : edges) {
+            ++offsets_[u + 1];
+        }
+        for (uint32_t u = 0; u < left_count; ++u) {
+            offsets_[u + 1] += offsets_[u];
+        }
+        std::vector<uint32_t> next(offsets_.begin(), offsets_.end() - 1);
+        for (const auto& [u, v] : edges) {
+            neighbours_[next[u]++] = v;
+        }
+    }
+
+    uint32_t LeftCount() const {
+        return offsets_.size() - 1;
+    }
+
+    uint32_t RightCount() const {
+        return right_count_;
+    }
+
+    uint32_t Begin(uint32_t u) const {
+        return offsets_[u];
+    }
+
+    uint32_t End(uint32_t u) const {
+        return offsets_[u + 1];
+    }
+
+    uint32_t Neighbour(uint32_t i) const {
+        return neighbours_[i];
+    }
+
+private:
+    uint32_t right_count_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> neighbours_;
+};
+
+
+namespace MatchingDetail {
+
+    // stack[i] went to the right vertex Neighbour(current[stack[i]]), which is
+    // matched to stack[i + 1]; the last one is free. Flips the path.
+    inline void Augment(const BipartiteGraph& graph, const std::vector<uint32_t>& stack,
+                        const std::vector<uint32_t>& current, Matching& matching) {
+        for (const uint32_t u : stack) {
+            const uint32_t v = graph.Neighbour(current[u]);
+            matching.left[u] = v;
+            matching.right[v] = u;
+        }
+        ++matching.size;
+    }
+
+}
+
+inline Matching KuhnMatching(const BipartiteGraph& graph) {
+    const uint32_t left_count = graph.LeftCount();
+    Matching matching{std::vector<uint32_t>(left_count, Matching::UNMATCHED),
+                      std::vector<uint32_t>(graph.RightCount(), Matching::UNMATCHED)};
+    std::vector<uint32_t> visited(left_count, 0);
+    std::vector<uint32_t> current(left_count);
+    std::vector<uint32_t> stack;
+    for (uint32_t root = 0; root < left_count; ++root) {
+        const uint32_t stamp = root + 1;
+        visited[root] = stamp;
+        current[root] = graph.Begin(root);
+        stack.assign(1, root);
+        while (!stack.empty()) {
+            const uint32_t u = stack.back();
+            if (current[u] == graph.End(u)) {
+                stack.pop_back();
+                if (!stack.empty()) {
+                    ++current[stack.back()];
+                }
+                continue;
+            }
+            const uint32_t w = matching.right[graph.Neighbour(current[u])];
+            if (w == Matching::UNMATCHED) {
+                MatchingDetail::Augment(graph, stack, current, matching);
+                break;
+            }
+            if (visited[w] != stamp) {
+                visited[w] = stamp;
+                current[w] = graph.Begin(w);
+                stack.push_back(w);
+            } else {
+                ++current[u];
+            }
+        }
+    }
+    return matching;
+}
+
+inline Matching HopcroftKarpMatching(const BipartiteGraph& graph) {
+    constexpr uint32_t INF = UINT32_MAX;
+    const uint32_t left_count = graph.LeftCount();
+    Matching matching{std::vector<uint32_t>(left_count, Matching::UNMATCHED),
+                      std::vector<uint32_t>(graph.RightCount(), Matching::UNMATCHED)};
+    for (uint32_t u = 0; u < left_count; ++u) {
+        for (uint32_t i = graph.Begin(u); i < graph.End(u); ++i) {
+            const uint32_t v = graph.Neighbour(i);
+            if (matching.right[v] == Matching::UNMATCHED) {
+                matching.left[u] = v;
+                matching.right[v] = u;
+                ++matching.size;
+                break;
+            }
+        }
+    }
+
+    std::vector<uint32_t> layer(left_count);
+    std::vector<uint32_t> current(left_count);
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> stack;
+    queue.reserve(left_count);
+    while (true) {
+        queue.clear();
+        for (uint32_t u = 0; u < left_count; ++u) {
+            layer[u] = matching.left[u] == Matching::UNMATCHED ? 0 : INF;
+            if (layer[u] == 0) {
+                queue.push_back(u);
+            }
+            current[u] = graph.Begin(u);
+        }
+        // layers deeper than the first free right vertex are not needed
+        uint32_t free_layer = INF;
+        for (size_t i = 0; i < queue.size() && layer[queue[i]] < free_layer; ++i) {
+            const uint32_t u = queue[i];
+            for (uint32_t j = graph.Begin(u); j < graph.End(u); ++j) {
+                const uint32_t w = matching.right[graph.Neighbour(j)];
+                if (w == Matching::UNMATCHED) {
+                    free_layer = layer[u];
+                } else if (layer[w] == INF) {
+                    layer[w] = layer[u] + 1;
+                    queue.push_back(w);
+                }
+            }
+        }
+        if (free_layer == INF) {
+            break;
+        }
+
+        for (uint32_t root = 0; root < left_count; ++root) {
+            if (layer[root] != 0) {
+                continue;
+            }
+            stack.assign(1, root);
+            while (!stack.empty()) {
+                const uint32_t u = stack.back();
+                if (current[u] == graph.End(u)) {
+                    layer[u] = INF;
+                    stack.pop_back();
+                    continue;
+                }
+                const uint32_t w = matching.right[graph.Neighbour(current[u])];
+                if (w == Matching::UNMATCHED && layer[u] == free_layer) {
+                    MatchingDetail::Augment(graph, stack, current, matching);
+                    // the vertices of the path are not free anymore
+                    for (const uint32_t v : stack) {
+                        layer[v] = INF;
+                    }
+                    break;
+                }
+                if (w != Matching::UNMATCHED && layer[w] == layer[u] + 1 && layer[u] < free_layer) {
+                    stack.push_back(w);
+                } else {
+                    ++current[u];
+                }
+            }
+        }
+    }
+    return matching;
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "flow_graph.h"
+
+// Max flow from source to sink; every function changes the residual capacities
+// of the graph (graph.Reset() before the next run) and returns the flow value.
+//
+// FordFulkersonMaxFlow - the seminar algorithm: search for any path by DFS,
+// push the bottleneck, repeat. O(E * flow).
+//
+// DinicMaxFlow - BFS levels from the source, then a blocking flow along arcs
+// that go one level up. Current arc: current[v] is the first arc of v that can
+// still lead to the sink in this phase, the arcs before it are never looked at
+// again, so a phase is O(VE). O(V^2 E) in total, O(E sqrt V) on unit networks
+// (matchings). DFS is iterative: paths are millions of vertices long.
+//
+// PushRelabelMaxFlow - the highest active vertex is discharged first.
+// Global relabel: heights are set to the exact BFS distances to the sink in
+// the residual graph at the start and again after every O(V + E) work of
+// relabels. Gap: if no vertex is left at height h, the vertices above h can't
+// reach the sink and are lifted to n at once. All vertices (not only the active
+// ones) are kept in lists by height, so a gap visits only the vertices above h,
+// each of them is lifted once: O(V) for all gaps. Only the first phase is run:
+// the value and the minimum cut are exact, but the residual capacities hold a
+// preflow, the excess of dead vertices is not returned to the source.
+
+namespace FlowDetail {
+
+    constexpr uint32_t NONE = UINT32_MAX;
+
+}
+
+inline int64_t FordFulkersonMaxFlow(FlowGraph& graph, uint32_t source, uint32_t sink) {
+    const uint32_t n = graph.VertexCount();
+    std::vector<uint32_t> visited(n, 0);
+    std::vector<uint32_t> parent_arc(n);
+    std::vector<uint32_t> stack;
+    int64_t total = 0;
+    for (uint32_t stamp = 1; source != sink; ++stamp) {
+        visited[source] = stamp;
+        stack.assign(1, source);
+        while (!stack.empty() && visited[sink] != stamp) {
+            const uint32_t v = stack.back();
+            stack.pop_back();
+            for (uint32_t arc = graph.Begin(v); arc < graph.End(v); ++arc) {
+                const uint32_t u = graph.Head(arc);
+                if (graph.Residual(arc) > 0 && visited[u] != stamp) {
+                    visited[u] = stamp;
+                    parent_arc[u] = arc;
+                    stack.push_back(u);
+                }
+            }
+        }
+        if (visited[sink] != stamp) {
+            break;
+        }
+        int64_t flow = INT64_MAX;
+        for (uint32_t v = sink; v != source; v = graph.Head(graph.Reverse(parent_arc[v]))) {
+            flow = std::min(flow, graph.Residual(parent_arc[v]));
+        }
+        for (uint32_t v = sink; v != source; v = graph.Head(graph.Reverse(parent_arc[v]))) {
+            graph.Push(parent_arc[v], flow);
+        }
+        total += flow;
+    }
+    return total;
+}
+
+inline int64_t DinicMaxFlow(FlowGraph& graph, uint32_t source, uint32_t sink) {
+    using FlowDetail::NONE;
+    const uint32_t n = graph.VertexCount();
+    std::vector<uint32_t> level(n);
+    std::vector<uint32_t> current(n);
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> path;
+    queue.reserve(n);
+    int64_t total = 0;
+    while (source != sink) {
+        std::fill(level.begin(), level.end(), NONE);
+        level[source] = 0;
+        queue.assign(1, source);
+        for (size_t i = 0; i < queue.size() && level[sink] == NONE; ++i) {
+            const uint32_t v = queue[i];
+            for (uint32_t arc = graph.Begin(v); arc < graph.End(v); ++arc) {
+                const uint32_t u = graph.Head(arc);
+                if (graph.Residual(arc) > 0 && level[u] == NONE) {
+                    level[u] = level[v] + 1;
+                    queue.push_back(u);
+                }
+            }
+        }
+        if (level[sink] == NONE) {
+            break;
+        }
+        for (uint32_t v = 0; v < n; ++v) {
+            current[v] = graph.Begin(v);
+        }
+
+        // blocking flow; path holds the arcs from the source to v
+        path.clear();
+        uint32_t v = source;
+        while (true) {
+            if (v == sink) {
+                int64_t flow = INT64_MAX;
+                for (const uint32_t arc : path) {
+                    flow = std::min(flow, graph.Residual(arc));
+                }
+                size_t saturated = path.size();
+                for (size_t i = 0; i < path.size(); ++i) {
+                    graph.Push(path[i], flow);
+                    if (saturated == path.size() && graph.Residual(path[i]) == 0) {
+                        saturated = i;
+                    }
+                }
+                total += flow;
+                // go on from the tail of the first saturated arc
+                path.resize(saturated);
+                v = path.empty() ? source : graph.Head(path.back());
+                continue;
+            }
+            uint32_t& arc = current[v];
+            while (arc < graph.End(v) && (graph.Residual(arc) == 0 || level[graph.Head(arc)] != level[v] + 1)) {
+                ++arc;
+            }
+            if (arc < graph.End(v)) {
+                path.push_back(arc);
+                v = graph.Head(arc);
+                continue;
+            }
+            // dead end: no arc of this phase leads into v anymore
+            level[v] = NONE;
+            if (v == source) {
+                break;
+            }
+            path.pop_back();
+            v = path.empty() ? source : graph.Head(path.back());
+            ++current[v];
+        }
+    }
+    return total;
+}
+
+inline int64_t PushRelabelMaxFlow(FlowGraph& graph, uint32_t source, uint32_t sink) {
+    using FlowDetail::NONE;
+    const uint32_t n = graph.VertexCount();
+    if (source == sink) {
+        return 0;
+    }
+    std::vector<uint32_t> height(n, 0);
+    std::vector<uint32_t> current(n);
+    std::vector<int64_t> excess(n, 0);
+    // active vertices by height; entries may be stale after a gap
+    std::vector<std::vector<uint32_t>> active(n);
+    std::vector<uint32_t> queue;
+    queue.reserve(n);
+    uint32_t highest = 0;
+    // all vertices below n by height, doubly linked lists; the heights
+    // 0..max_height are all used (an empty one is a gap and cuts off the rest)
+    std::vector<uint32_t> first(n, NONE);
+    std::vector<uint32_t> next(n);
+    std::vector<uint32_t> prev(n);
+    uint32_t max_height = 0;
+
+    auto activate = [&](uint32_t v) {
+        active[height[v]].push_back(v);
+        highest = std::max(highest, height[v]);
+    };
+
+    auto link = [&](uint32_t v) {
+        const uint32_t h = height[v];
+        prev[v] = NONE;
+        next[v] = first[h];
+        if (first[h] != NONE) {
+            prev[first[h]] = v;
+        }
+        first[h] = v;
+        max_height = std::max(max_height, h);
+    };
+
+    auto unlink = [&](uint32_t v) {
+        if (prev[v] != NONE) {
+            next[prev[v]] = next[v];
+        } else {
+            first[height[v]] = next[v];
+        }
+        if (next[v] != NONE) {
+            prev[next[v]] = prev[v];
+        }
+    };
+
+    auto global_relabel = [&] {
+        std::fill(height.begin(), height.end(), n);
+        std::fill(first.begin(), first.end(), NONE);
+        height[sink] = 0;
+        queue.assign(1, sink);
+        for (size_t i = 0; i < queue.size(); ++i) {
+            const uint32_t v = queue[i];
+            for (uint32_t arc = graph.Begin(v); arc < graph.End(v); ++arc) {
+                const uint32_t u = graph.Head(arc);
+                if (height[u] == n && u != source && graph.Residual(graph.Reverse(arc)) > 0) {
+                    height[u] = height[v] + 1;
+                    queue.push_back(u);
+                }
+            }
+        }
+        for (auto& bucket : active) {
+            bucket.clear();
+        }
+        highest = 0;
+        max_height = 0;
+        for (uint32_t v = 0; v < n; ++v) {
+            current[v] = graph.Begin(v);
+            if (height[v] < n) {
+                link(v);
+                if (v != sink && excess[v] > 0) {
+                    activate(v);
+                }
+            }
+        }
+    };
+
+    for (uint32_t arc = graph.Begin(source); arc < graph.End(source); ++arc) {
+        const int64_t flow = graph.Residual(arc);
+        graph.Push(arc, flow);
+        excess[graph.Head(arc)] += flow;
+        excess[source] -= flow;
+    }
+    global_relabel();
+
+    const size_t relabel_period = n + graph.ArcCount();
+    size_t work = 0;
+    while (true) {
+        while (highest > 0 && active[highest].empty()) {
+            --highest;
+        }
+        if (active[highest].empty()) {
+            break;
+        }
+        const uint32_t u = active[highest].back();
+        active[highest].pop_back();
+        if (height[u] != highest) {
+            continue;
+        }
+
+        // discharge
+        while (excess[u] > 0) {
+            if (current[u] == graph.End(u)) {
+                uint32_t new_height = n;
+                for (uint32_t arc = graph.Begin(u); arc < graph.End(u); ++arc) {
+                    if (graph.Residual(arc) > 0) {
+                        new_height = std::min(new_height, height[graph.Head(arc)] + 1);
+                    }
+                }
+                work += graph.End(u) - graph.Begin(u) + 1;
+                const uint32_t old_height = height[u];
+                unlink(u);
+                if (first[old_height] == NONE) {
+                    // gap: u and everything above it can't reach the sink
+                    for (uint32_t h = old_height + 1; h <= max_height; ++h) {
+                        for (uint32_t v = first[h]; v != NONE; v = next[v]) {
+                            height[v] = n;
+                        }
+                        first[h] = NONE;
+                    }
+                    max_height = old_height > 0 ? old_height - 1 : 0;
+                    new_height = n;
+                }
+                height[u] = new_height;
+                if (new_height == n) {
+                    break;
+                }
+                link(u);
+                current[u] = graph.Begin(u);
+                continue;
+            }
+            const uint32_t arc = current[u];
+            const uint32_t v = graph.Head(arc);
+            if (graph.Residual(arc) > 0 && height[u] == height[v] + 1) {
+                const int64_t flow = std::min(excess[u], graph.Residual(arc));
+                graph.Push(arc, flow);
+                excess[u] -= flow;
+                if (excess[v] == 0 && v != sink) {
+                    activate(v);
+                }
+                excess[v] += flow;
+            } else {
+                ++current[u];
+            }
+        }
+        if (work > relabel_period) {
+            work = 0;
+            global_relabel();
+        }
+    }
+    return excess[sink];
+}
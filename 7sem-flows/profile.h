@@ -0,0 +1,193 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <sstream>
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+class LogDuration {
+public:
+  explicit LogDuration(const std::string& msg = "")
+    : message(msg + ": ")
+    , start(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~LogDuration() {
+    auto finish = std::chrono::steady_clock::now();
+    auto dur = finish - start;
+    std::ostringstream os;
+    os << message
+       << std::chrono::duration_cast<std::chrono::milliseconds>(dur).count()
+       << " ms" << std::endl;
+    std::cerr << os.str();
+  }
+private:
+  std::string message;
+  std::chrono::steady_clock::time_point start;
+};
+
+// Same as LogDuration, but also reads hardware counters of the scope
+// (perf_event_open, linux only). Threads spawned inside the scope are counted
+// too; threads that already existed (e.g. tbb pool) are not.
+// If a counter can't be opened (no PMU in VM, perf_event_paranoid, not linux)
+// it is printed as n/a, the duration is printed anyway.
+class PerfScope {
+public:
+  explicit PerfScope(const std::string& msg = "")
+    : message(msg + ": ")
+  {
+#ifdef __linux__
+    fds[CYCLES] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[INSTRUCTIONS] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[L1D_LOADS] = Open(PERF_TYPE_HW_CACHE, CacheConfig(PERF_COUNT_HW_CACHE_RESULT_ACCESS));
+    fds[L1D_MISSES] = Open(PERF_TYPE_HW_CACHE, CacheConfig(PERF_COUNT_HW_CACHE_RESULT_MISS));
+    fds[LLC_REFERENCES] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+    fds[LLC_MISSES] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fds[BRANCHES] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+    fds[BRANCH_MISSES] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    // switches happen in the kernel, with exclude_kernel the counter is always 0
+    fds[CONTEXT_SWITCHES] = Open(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false);
+    for (int fd : fds) {
+      if (fd != -1) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+    start = std::chrono::steady_clock::now();
+  }
+
+  PerfScope(const PerfScope&) = delete;
+  PerfScope& operator=(const PerfScope&) = delete;
+
+  ~PerfScope() {
+    auto finish = std::chrono::steady_clock::now();
+    std::optional<double> values[COUNTER_COUNT];
+#ifdef __linux__
+    for (int i = 0; i != COUNTER_COUNT; ++i) {
+      values[i] = Read(fds[i]);
+    }
+#endif
+
+    std::ostringstream os;
+    os << message
+       << std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count()
+       << " ms";
+
+    bool any = false;
+    for (const auto& value : values) {
+      any = any || value.has_value();
+    }
+    if (!any) {
+      os << " (perf counters unavailable)" << std::endl;
+      std::cerr << os.str();
+      return;
+    }
+
+    os << ", cycles " << Count(values[CYCLES])
+       << ", instructions " << Count(values[INSTRUCTIONS])
+       << ", IPC " << Ratio(values[INSTRUCTIONS], values[CYCLES], 1)
+       << ", L1d miss " << Ratio(values[L1D_MISSES], values[L1D_LOADS], 100, "%")
+       << ", LLC miss " << Ratio(values[LLC_MISSES], values[LLC_REFERENCES], 100, "%")
+       << ", branch miss " << Ratio(values[BRANCH_MISSES], values[BRANCHES], 100, "%")
+       << ", context switches " << Count(values[CONTEXT_SWITCHES])
+       << std::endl;
+    std::cerr << os.str();
+  }
+
+private:
+  enum Counter {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_LOADS,
+    L1D_MISSES,
+    LLC_REFERENCES,
+    LLC_MISSES,
+    BRANCHES,
+    BRANCH_MISSES,
+    CONTEXT_SWITCHES,
+    COUNTER_COUNT
+  };
+
+#ifdef __linux__
+  static uint64_t CacheConfig(uint64_t result) {
+    return PERF_COUNT_HW_CACHE_L1D
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (result << 16);
+  }
+
+  static int Open(uint32_t type, uint64_t config, bool exclude_kernel = true) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = exclude_kernel;
+    attr.exclude_hv = 1;
+    // there are less hardware counters than events, kernel multiplexes them
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  // value scaled by the time the counter actually was on the pmu
+  static std::optional<double> Read(int fd) {
+    if (fd == -1) {
+      return std::nullopt;
+    }
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t data[3] = {0, 0, 0};
+    const bool ok = read(fd, data, sizeof(data)) == sizeof(data);
+    close(fd);
+    if (!ok || data[2] == 0) {
+      return std::nullopt;
+    }
+    return static_cast<double>(data[0]) * data[1] / data[2];
+  }
+#endif
+
+  static std::string Count(const std::optional<double>& value) {
+    if (!value) {
+      return "n/a";
+    }
+    std::ostringstream os;
+    os << static_cast<uint64_t>(*value);
+    return os.str();
+  }
+
+  static std::string Ratio(const std::optional<double>& num, const std::optional<double>& den,
+                           double scale, const char* suffix = "") {
+    if (!num || !den || *den == 0) {
+      return "n/a";
+    }
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2) << *num / *den * scale << suffix;
+    return os.str();
+  }
+
+  std::string message;
+  std::chrono::steady_clock::time_point start;
+  int fds[COUNTER_COUNT] = {-1, -1, -1, -1, -1, -1, -1, -1, -1};
+};
+
+#ifndef UNIQ_ID
+  #define UNIQ_ID_IMPL(lineno) _a_local_var_##lineno
+  #define UNIQ_ID(lineno) UNIQ_ID_IMPL(lineno)
+#endif
+
+#define LOG_DURATION(message) \
+  LogDuration UNIQ_ID(__LINE__){message};
+
+#define PERF_SCOPE(message) \
+  PerfScope UNIQ_ID(__LINE__){message};
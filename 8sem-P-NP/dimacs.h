@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "sat_solver.h"
+
+// CNF in the DIMACS format:
+//
+//   c a comment
+//   p cnf <variables> <clauses>
+//   1 -2 3 0
+//   -1 0
+//
+// A clause is a list of literals (x or -x, 1 <= x <= variables) ended by 0,
+// it may span several lines. Reading stops at a line "%" (SATLIB files end so).
+
+struct Cnf {
+    uint32_t variable_count = 0;
+    std::vector<std::vector<int>> clauses;
+};
+
+// false if the input is not DIMACS: no header, a literal out of range,
+// a clause without the final 0 or a wrong number of clauses
+inline bool ReadDimacs(std::istream& in, Cnf& cnf) {
+    cnf = {};
+    std::string token;
+    int64_t declared_clauses = -1;
+    std::vector<int> clause;
+    while (in >> token) {
+        if (token[0] == 'c') {
+            std::getline(in, token);
+            continue;
+        }
+        if (token == "%") {
+            break;
+        }
+        if (token == "p") {
+            int64_t variables = -1;
+            if (declared_clauses >= 0 || !(in >> token) || token != "cnf" || !(in >> variables >> declared_clauses)
+                || variables < 0 || variables > INT32_MAX || declared_clauses < 0) {
+                return false;
+            }
+            cnf.variable_count = variables;
+            continue;
+        }
+        char* end = nullptr;
+        const long long literal = std::strtoll(token.c_str(), &end, 10);
+        if (declared_clauses < 0 || *end != '\0' || literal > cnf.variable_count || literal < -static_cast<long long>(cnf.variable_count)) {
+            return false;
+        }
+        if (literal == 0) {
+            cnf.clauses.push_back(std::move(clause));
+            clause.clear();
+        } else {
+            clause.push_back(literal);
+        }
+    }
+    return declared_clauses >= 0 && clause.empty() && static_cast<int64_t>(cnf.clauses.size()) == declared_clauses;
+}
+
+inline void WriteDimacs(std::ostream& out, const Cnf& cnf) {
+    out << "p cnf " << cnf.variable_count << ' ' << cnf.clauses.size() << '\n';
+    for (const auto& clause : cnf.clauses) {
+        for (const int literal : clause) {
+            out << literal << ' ';
+        }
+        out << "0\n";
+    }
+}
+
+// false if the formula is unsatisfiable already
+inline bool AddCnf(SatSolver& solver, const Cnf& cnf) {
+    while (solver.VariableCount() < cnf.variable_count) {
+        solver.NewVariable();
+    }
+    bool ok = true;
+    for (const auto& clause : cnf.clauses) {
+        ok = solver.AddClause(clause) && ok;
+    }
+    return ok;
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "dimacs.h"
+#include "sat_solver.h"
+
+// 0/1 knapsack as SAT: is there a subset of the items with the total weight at
+// most max_weight and the total cost at least min_cost? Costs and weights are
+// non-negative.
+//
+// Variable i (1..n) - the i-th item is taken. The item contributes the number
+// weight * x_i, its bits are x_i where weight has ones and false elsewhere.
+// The numbers are summed by a balanced tree of ripple carry adders (full adder:
+// sum = a ^ b ^ c, carry = majority(a, b, c)), the sum is compared with the
+// constant bit by bit from the low bits:
+//   le_{k+1} = K_k ? !s_k | le_k : !s_k & le_k   (s mod 2^k <= K mod 2^k)
+// Every gate is a new variable with the Tseitin clauses; gates with a constant
+// input fold, so the zero bits of the weights cost nothing.
+//
+// KnapsackMaxCostSat finds the optimum by a binary search on min_cost,
+// a new solver for every probe, a found subset raises the lower bound to its cost.
+
+// the same as in 9sem-optimized-brute-force/knapsack.cpp
+struct Item {
+    int cost = 0;
+    int weight = 0;
+};
+
+constexpr int NO_SOLUTION_COST = std::numeric_limits<int>::min();
+
+namespace KnapsackCnfDetail {
+
+    // literal of the CNF or a constant
+    constexpr int TRUE_LITERAL = std::numeric_limits<int>::max();
+    constexpr int FALSE_LITERAL = -TRUE_LITERAL;
+
+    using Number = std::vector<int>;  // bits from the low one
+
+    class CnfBuilder {
+    public:
+        explicit CnfBuilder(uint32_t input_count) {
+            cnf_.variable_count = input_count;
+        }
+
+        int And(int a, int b) {
+            if (a == FALSE_LITERAL || b == FALSE_LITERAL || a == -b) {
+                return FALSE_LITERAL;
+            }
+            if (a == TRUE_LITERAL || a == b) {
+                return b;
+            }
+            if (b == TRUE_LITERAL) {
+                return a;
+            }
+            const int gate = NewVariable();
+            cnf_.clauses.push_back({-gate, a});
+            cnf_.clauses.push_back({-gate, b});
+            cnf_.clauses.push_back({gate, -a, -b});
+            return gate;
+        }
+
+        int Or(int a, int b) {
+            return -And(-a, -b);
+        }
+
+        int Xor(int a, int b) {
+            if (a == FALSE_LITERAL || a == TRUE_LITERAL) {
+                return a == TRUE_LITERAL ? -b : b;
+            }
+            if (b == FALSE_LITERAL || b == TRUE_LITERAL) {
+                return b == TRUE_LITERAL ? -a : a;
+            }
+            if (a == b || a == -b) {
+                return a == b ? FALSE_LITERAL : TRUE_LITERAL;
+            }
+            const int gate = NewVariable();
+            cnf_.clauses.push_back({-gate, a, b});
+            cnf_.clauses.push_back({-gate, -a, -b});
+            cnf_.clauses.push_back({gate, -a, b});
+            cnf_.clauses.push_back({gate, a, -b});
+            return gate;
+        }
+
+        int Majority(int a, int b, int c) {
+            if (c == FALSE_LITERAL || c == TRUE_LITERAL) {
+                return c == TRUE_LITERAL ? Or(a, b) : And(a, b);
+            }
+            if (a == FALSE_LITERAL || a == TRUE_LITERAL) {
+                return Majority(b, c, a);
+            }
+            if (b == FALSE_LITERAL || b == TRUE_LITERAL) {
+                return Majority(a, c, b);
+            }
+            const int gate = NewVariable();
+            cnf_.clauses.push_back({-gate, a, b});
+            cnf_.clauses.push_back({-gate, a, c});
+            cnf_.clauses.push_back({-gate, b, c});
+            cnf_.clauses.push_back({gate, -a, -b});
+            cnf_.clauses.push_back({gate, -a, -c});
+            cnf_.clauses.push_back({gate, -b, -c});
+            return gate;
+        }
+
+        Number Add(const Number& a, const Number& b) {
+            Number sum;
+            int carry = FALSE_LITERAL;
+            for (size_t k = 0; k < std::max(a.size(), b.size()); ++k) {
+                const int x = k < a.size() ? a[k] : FALSE_LITERAL;
+                const int y = k < b.size() ? b[k] : FALSE_LITERAL;
+                sum.push_back(Xor(Xor(x, y), carry));
+                carry = Majority(x, y, carry);
+            }
+            sum.push_back(carry);
+            while (!sum.empty() && sum.back() == FALSE_LITERAL) {
+                sum.pop_back();
+            }
+            return sum;
+        }
+
+        // number <= bound
+        int LessOrEqual(const Number& number, int64_t bound) {
+            if (bound < 0) {
+                return FALSE_LITERAL;
+            }
+            if (number.size() < 63 && bound >> number.size() != 0) {
+                return TRUE_LITERAL;
+            }
+            int result = TRUE_LITERAL;
+            for (size_t k = 0; k < number.size(); ++k) {
+                const bool bit = k < 63 && (bound >> k & 1);
+                result = bit ? Or(-number[k], result) : And(-number[k], result);
+            }
+            return result;
+        }
+
+        // number >= bound
+        int GreaterOrEqual(const Number& number, int64_t bound) {
+            if (bound <= 0) {
+                return TRUE_LITERAL;
+            }
+            if (number.size() < 63 && bound >> number.size() != 0) {
+                return FALSE_LITERAL;
+            }
+            int result = TRUE_LITERAL;
+            for (size_t k = 0; k < number.size(); ++k) {
+                const bool bit = k < 63 && (bound >> k & 1);
+                result = bit ? And(number[k], result) : Or(number[k], result);
+            }
+            return result;
+        }
+
+        void Require(int literal) {
+            if (literal == FALSE_LITERAL) {
+                cnf_.clauses.emplace_back();
+            } else if (literal != TRUE_LITERAL) {
+                cnf_.clauses.push_back({literal});
+            }
+        }
+
+        Cnf Release() {
+            return std::move(cnf_);
+        }
+
+    private:
+        int NewVariable() {
+            return ++cnf_.variable_count;
+        }
+
+        Cnf cnf_;
+    };
+
+    // sum of value(item) * x_i
+    template<typename Value>
+    Number WeightedSum(CnfBuilder& builder, const std::vector<Item>& items, Value value) {
+        std::deque<Number> numbers;
+        for (size_t i = 0; i < items.size(); ++i) {
+            Number number;
+            for (int64_t rest = value(items[i]); rest > 0; rest >>= 1) {
+                number.push_back(rest & 1 ? static_cast<int>(i + 1) : FALSE_LITERAL);
+            }
+            numbers.push_back(std::move(number));
+        }
+        if (numbers.empty()) {
+            return {};
+        }
+        while (numbers.size() > 1) {
+            numbers.push_back(builder.Add(numbers[0], numbers[1]));
+            numbers.pop_front();
+            numbers.pop_front();
+        }
+        return numbers.front();
+    }
+
+}
+
+// variables 1..items.size() are the items
+inline Cnf KnapsackCnf(const std::vector<Item>& items, int max_weight, int64_t min_cost) {
+    using namespace KnapsackCnfDetail;
+    CnfBuilder builder(items.size());
+    const Number weight = WeightedSum(builder, items, [](Item item) { return item.weight; });
+    builder.Require(builder.LessOrEqual(weight, max_weight));
+    const Number cost = WeightedSum(builder, items, [](Item item) { return item.cost; });
+    builder.Require(builder.GreaterOrEqual(cost, min_cost));
+    return builder.Release();
+}
+
+// the maximum cost of a subset with the weight at most max_weight,
+// NO_SOLUTION_COST if max_weight < 0; stats of all the probes are summed into stats
+inline int KnapsackMaxCostSat(const std::vector<Item>& items, int max_weight, SatStats* stats = nullptr) {
+    if (max_weight < 0) {
+        return NO_SOLUTION_COST;
+    }
+    int64_t low = 0;
+    int64_t high = 0;
+    for (const Item item : items) {
+        high += item.cost;
+    }
+    while (low < high) {
+        const int64_t middle = low + (high - low + 1) / 2;
+        SatSolver solver;
+        AddCnf(solver, KnapsackCnf(items, max_weight, middle));
+        const SatResult result = solver.Solve();
+        if (stats) {
+            const SatStats& probe = solver.Stats();
+            stats->decisions += probe.decisions;
+            stats->propagations += probe.propagations;
+            stats->conflicts += probe.conflicts;
+            stats->restarts += probe.restarts;
+            stats->reductions += probe.reductions;
+            stats->learnt_literals += probe.learnt_literals;
+        }
+        if (result == SatResult::SAT) {
+            int64_t cost = 0;
+            for (size_t i = 0; i < items.size(); ++i) {
+                cost += solver.Model(i + 1) ? items[i].cost : 0;
+            }
+            low = cost;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
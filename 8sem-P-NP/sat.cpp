@@ -0,0 +1,44 @@
+#include <fstream>
+#include <iostream>
+#include "dimacs.h"
+#include "sat_solver.h"
+
+using namespace std;
+
+// Solves a DIMACS CNF from the file or stdin, the answer in the format of the
+// SAT competitions: "s SATISFIABLE" and the assignment in "v" lines, or
+// "s UNSATISFIABLE"; the statistics go to stderr.
+// usage: ./sat [file.cnf]
+
+int main(int argc, char* argv[]) {
+    Cnf cnf;
+    ifstream file;
+    if (argc > 1) {
+        file.open(argv[1]);
+    }
+    if (!ReadDimacs(argc > 1 ? file : cin, cnf)) {
+        cerr << "not a DIMACS CNF" << endl;
+        return 1;
+    }
+    SatSolver solver;
+    AddCnf(solver, cnf);
+    const SatResult result = solver.Solve();
+    const SatStats& stats = solver.Stats();
+    cerr << "c " << stats.conflicts << " conflicts, " << stats.decisions << " decisions, "
+         << stats.propagations << " propagations, " << stats.restarts << " restarts, "
+         << stats.reductions << " reductions" << endl;
+    if (result != SatResult::SAT) {
+        cout << "s UNSATISFIABLE" << endl;
+        return 20;
+    }
+    cout << "s SATISFIABLE" << endl;
+    cout << 'v';
+    for (uint32_t x = 1; x <= cnf.variable_count; ++x) {
+        cout << ' ' << (solver.Model(x) ? static_cast<int>(x) : -static_cast<int>(x));
+        if (x % 20 == 0) {
+            cout << "\nv";
+        }
+    }
+    cout << " 0" << endl;
+    return 10;
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "dimacs.h"
+#include "knapsack_cnf.h"
+#include "sat_solver.h"
+
+using namespace std;
+
+// Speed of the CDCL solver, propagations (assigned literals taken from the trail)
+// per second, on:
+// - random 3-SAT at the threshold (4.26 clauses per variable) - half of them
+//   are satisfiable, the hardest random instances for their size;
+// - pigeonhole: n + 1 pigeons don't fit into n holes, exponential for resolution
+//   and so for CDCL, a small n gives many conflicts;
+// - knapsack of knapsack.cpp (costs up to 10^4, weights up to 10^6) through
+//   KnapsackMaxCostSat, checked by the brute force over all subsets.
+// A found assignment is checked against the clauses.
+// usage: ./sat_bench [variables] [instances]   (200 and 10 by default)
+
+Cnf Random3Sat(mt19937& generator, uint32_t variable_count, double ratio) {
+    Cnf cnf;
+    cnf.variable_count = variable_count;
+    const size_t clause_count = variable_count * ratio;
+    uniform_int_distribution<int> variable(1, variable_count);
+    for (size_t i = 0; i < clause_count; ++i) {
+        vector<int> clause;
+        while (clause.size() < 3) {
+            const int x = variable(generator);
+            if (find(clause.begin(), clause.end(), x) == clause.end() && find(clause.begin(), clause.end(), -x) == clause.end()) {
+                clause.push_back(generator() & 1 ? x : -x);
+            }
+        }
+        cnf.clauses.push_back(clause);
+    }
+    return cnf;
+}
+
+// variable p * holes + h + 1 - pigeon p sits in hole h
+Cnf Pigeonhole(uint32_t holes) {
+    Cnf cnf;
+    const uint32_t pigeons = holes + 1;
+    cnf.variable_count = pigeons * holes;
+    auto sits = [holes](uint32_t p, uint32_t h) { return static_cast<int>(p * holes + h + 1); };
+    for (uint32_t p = 0; p < pigeons; ++p) {
+        vector<int> clause;
+        for (uint32_t h = 0; h < holes; ++h) {
+            clause.push_back(sits(p, h));
+        }
+        cnf.clauses.push_back(clause);
+    }
+    for (uint32_t h = 0; h < holes; ++h) {
+        for (uint32_t p = 0; p < pigeons; ++p) {
+            for (uint32_t q = p + 1; q < pigeons; ++q) {
+                cnf.clauses.push_back({-sits(p, h), -sits(q, h)});
+            }
+        }
+    }
+    return cnf;
+}
+
+bool Satisfies(const SatSolver& solver, const Cnf& cnf) {
+    for (const auto& clause : cnf.clauses) {
+        bool satisfied = false;
+        for (const int literal : clause) {
+            satisfied = satisfied || solver.Model(abs(literal)) == (literal > 0);
+        }
+        if (!satisfied) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Report(const string& title, const SatStats& stats, double seconds) {
+    cerr << "  " << title << ": " << static_cast<int64_t>(seconds * 1000) << " ms, "
+         << stats.conflicts << " conflicts, " << stats.decisions << " decisions, "
+         << stats.propagations << " propagations, "
+         << stats.propagations / max(seconds, 1e-9) / 1e6 << " M propagations/s" << endl;
+}
+
+double Seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void BenchCnf(const string& title, const vector<Cnf>& instances) {
+    cerr << title << ": " << instances.size() << " instances, "
+         << instances[0].variable_count << " variables, " << instances[0].clauses.size() << " clauses" << endl;
+    SatStats total;
+    double seconds = 0;
+    int satisfiable = 0;
+    for (const Cnf& cnf : instances) {
+        SatSolver solver;
+        const auto start = chrono::steady_clock::now();
+        AddCnf(solver, cnf);
+        const SatResult result = solver.Solve();
+        seconds += Seconds(start);
+        if (result == SatResult::SAT) {
+            ++satisfiable;
+            if (!Satisfies(solver, cnf)) {
+                cout << "WRONG RESULT" << endl;
+            }
+        }
+        const SatStats& stats = solver.Stats();
+        total.conflicts += stats.conflicts;
+        total.decisions += stats.decisions;
+        total.propagations += stats.propagations;
+    }
+    Report("satisfiable " + to_string(satisfiable), total, seconds);
+}
+
+int BruteForceKnapsack(const vector<Item>& items, int max_weight) {
+    int best = 0;
+    for (uint32_t mask = 0; mask < (1u << items.size()); ++mask) {
+        int64_t cost = 0;
+        int64_t weight = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (mask >> i & 1) {
+                cost += items[i].cost;
+                weight += items[i].weight;
+            }
+        }
+        if (weight <= max_weight && cost > best) {
+            best = cost;
+        }
+    }
+    return best;
+}
+
+void BenchKnapsack(mt19937& generator, int item_count, int max_weight) {
+    vector<Item> items(item_count);
+    for (Item& item : items) {
+        item.cost = uniform_int_distribution<int>(1, 10'000)(generator);
+        item.weight = uniform_int_distribution<int>(1, 1'000'000)(generator);
+    }
+    const Cnf cnf = KnapsackCnf(items, max_weight, 1);
+    cerr << "knapsack: " << item_count << " items, max weight " << max_weight << ", "
+         << cnf.variable_count << " variables, " << cnf.clauses.size() << " clauses per probe" << endl;
+    SatStats stats;
+    const auto start = chrono::steady_clock::now();
+    const int cost = KnapsackMaxCostSat(items, max_weight, &stats);
+    Report("KnapsackMaxCostSat", stats, Seconds(start));
+    int expected;
+    {
+        const auto brute_start = chrono::steady_clock::now();
+        expected = BruteForceKnapsack(items, max_weight);
+        cerr << "  brute force: " << static_cast<int64_t>(Seconds(brute_start) * 1000) << " ms" << endl;
+    }
+    if (cost != expected) {
+        cout << "WRONG RESULT" << endl;
+    }
+    cerr << "  cost " << cost << endl;
+}
+
+
+int main(int argc, char* argv[]) {
+    const uint32_t variable_count = argc > 1 ? stoul(argv[1]) : 200;
+    const uint32_t instance_count = argc > 2 ? stoul(argv[2]) : 10;
+    mt19937 generator;
+
+    vector<Cnf> random;
+    for (uint32_t i = 0; i < instance_count; ++i) {
+        random.push_back(Random3Sat(generator, variable_count, 4.26));
+    }
+    BenchCnf("random 3-SAT", random);
+    BenchCnf("pigeonhole", {Pigeonhole(9)});
+    BenchKnapsack(generator, 20, 5'000'000);
+    BenchKnapsack(generator, 25, 10'000'000);
+}
@@ -0,0 +1,597 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// CDCL SAT solver.
+//
+// Variables are 1..n, literals in the DIMACS form: x or -x. Inside a literal is
+// 2 * (x - 1) + sign, so ~literal is literal ^ 1 and the value of a literal is
+// one array read.
+//
+// Clauses lie one after another in a flat arena of uint32: a header (size,
+// LBD and flags) and the literals; a clause is its offset in the arena.
+// Propagation watches two literals of every clause (the first two): when one
+// of them becomes false another non-false literal is searched for, only if there
+// is none the clause is unit or a conflict. A watch holds a blocker - some other
+// literal of the clause, if it is true the clause isn't touched at all.
+//
+// A conflict gives a learnt clause by the first UIP, its literals implied by
+// the others are removed (a literal whose reason consists of literals of the
+// clause). Decisions are by VSIDS: the variables of the conflict get +inc,
+// inc grows by 1 / DECAY after each conflict; the unassigned variable with the
+// largest activity is taken from a binary heap, with the last value it had
+// (phase saving). Restarts follow the Luby sequence (RESTART_UNIT conflicts
+// times 1 1 2 1 1 2 4 ...).
+//
+// Reduction of the learnt clauses happens at a restart, at decision level 0,
+// where no clause is a reason anymore: clauses satisfied at level 0 are deleted,
+// of the learnt ones with LBD > 2 (LBD - the number of distinct decision levels
+// in the clause when it was learnt) the worse half by LBD is deleted, the arena
+// is compacted and the watches are built anew. A reduction that is due forces
+// the restart.
+
+enum class SatResult {
+    SAT,
+    UNSAT,
+    UNKNOWN,
+};
+
+struct SatStats {
+    uint64_t decisions = 0;
+    uint64_t propagations = 0;
+    uint64_t conflicts = 0;
+    uint64_t restarts = 0;
+    uint64_t reductions = 0;
+    uint64_t learnt_literals = 0;
+};
+
+namespace SatDetail {
+
+    constexpr uint32_t NONE = UINT32_MAX;
+    constexpr uint32_t HEADER = 2;
+    constexpr uint32_t LEARNT = 1u << 30;
+    constexpr uint32_t DELETED = 1u << 31;
+    constexpr uint32_t LBD_MASK = LEARNT - 1;
+
+    constexpr double DECAY = 0.95;
+    constexpr uint64_t RESTART_UNIT = 100;
+    constexpr uint64_t FIRST_REDUCTION = 2000;
+    constexpr uint64_t REDUCTION_STEP = 300;
+
+    inline uint32_t Literal(int dimacs) {
+        return dimacs > 0 ? 2 * (dimacs - 1) : 2 * (-dimacs - 1) + 1;
+    }
+
+    // 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+    inline uint64_t Luby(uint64_t i) {
+        uint64_t size = 1;
+        int power = 0;
+        while (size < i + 1) {
+            size = 2 * size + 1;
+            ++power;
+        }
+        while (size - 1 != i) {
+            size = (size - 1) / 2;
+            --power;
+            i %= size;
+        }
+        return uint64_t{1} << power;
+    }
+
+    struct Watch {
+        uint32_t clause;
+        uint32_t blocker;
+    };
+
+    // max-heap of variables by activity
+    class ActivityHeap {
+    public:
+        explicit ActivityHeap(const std::vector<double>& activity)
+            : activity_(activity)
+        {
+        }
+
+        void Grow(uint32_t variable_count) {
+            position_.resize(variable_count, NONE);
+        }
+
+        bool Empty() const {
+            return heap_.empty();
+        }
+
+        bool Contains(uint32_t variable) const {
+            return position_[variable] != NONE;
+        }
+
+        void Insert(uint32_t variable) {
+            if (Contains(variable)) {
+                return;
+            }
+            position_[variable] = heap_.size();
+            heap_.push_back(variable);
+            SiftUp(position_[variable]);
+        }
+
+        // after the activity of the variable grew
+        void Increased(uint32_t variable) {
+            if (Contains(variable)) {
+                SiftUp(position_[variable]);
+            }
+        }
+
+        uint32_t PopMax() {
+            const uint32_t top = heap_[0];
+            position_[top] = NONE;
+            const uint32_t last = heap_.back();
+            heap_.pop_back();
+            if (!heap_.empty()) {
+                heap_[0] = last;
+                position_[last] = 0;
+                SiftDown(0);
+            }
+            return top;
+        }
+
+    private:
+        void SiftUp(uint32_t i) {
+            const uint32_t variable = heap_[i];
+            while (i > 0 && activity_[heap_[(i - 1) / 2]] < activity_[variable]) {
+                heap_[i] = heap_[(i - 1) / 2];
+                position_[heap_[i]] = i;
+                i = (i - 1) / 2;
+            }
+            heap_[i] = variable;
+            position_[variable] = i;
+        }
+
+        void SiftDown(uint32_t i) {
+            const uint32_t variable = heap_[i];
+            const uint32_t size = heap_.size();
+            while (2 * i + 1 < size) {
+                uint32_t child = 2 * i + 1;
+                if (child + 1 < size && activity_[heap_[child + 1]] > activity_[heap_[child]]) {
+                    ++child;
+                }
+                if (activity_[heap_[child]] <= activity_[variable]) {
+                    break;
+                }
+                heap_[i] = heap_[child];
+                position_[heap_[i]] = i;
+                i = child;
+            }
+            heap_[i] = variable;
+            position_[variable] = i;
+        }
+
+        const std::vector<double>& activity_;
+        std::vector<uint32_t> heap_;
+        std::vector<uint32_t> position_;
+    };
+
+}
+
+class SatSolver {
+public:
+    explicit SatSolver(uint32_t variable_count = 0) {
+        while (VariableCount() < variable_count) {
+            NewVariable();
+        }
+    }
+
+    SatSolver(const SatSolver&) = delete;
+    SatSolver& operator=(const SatSolver&) = delete;
+
+    // returns the number of the new variable
+    int NewVariable() {
+        const uint32_t variable = level_.size();
+        value_.push_back(0);
+        value_.push_back(0);
+        watches_.emplace_back();
+        watches_.emplace_back();
+        level_.push_back(0);
+        reason_.push_back(SatDetail::NONE);
+        activity_.push_back(0.0);
+        phase_.push_back(1);
+        seen_.push_back(0);
+        model_.push_back(false);
+        heap_.Grow(level_.size());
+        heap_.Insert(variable);
+        return variable + 1;
+    }
+
+    uint32_t VariableCount() const {
+        return level_.size();
+    }
+
+    // clause of DIMACS literals, new variables are created as needed;
+    // false if the formula is already unsatisfiable
+    bool AddClause(const std::vector<int>& clause) {
+        using namespace SatDetail;
+        if (!ok_) {
+            return false;
+        }
+        Backtrack(0);
+        std::vector<uint32_t> literals;
+        literals.reserve(clause.size());
+        for (const int dimacs : clause) {
+            while (VariableCount() < static_cast<uint32_t>(std::abs(dimacs))) {
+                NewVariable();
+            }
+            literals.push_back(Literal(dimacs));
+        }
+        std::sort(literals.begin(), literals.end());
+        literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+        size_t kept = 0;
+        for (size_t i = 0; i < literals.size(); ++i) {
+            if (Value(literals[i]) > 0 || (i + 1 < literals.size() && literals[i + 1] == (literals[i] ^ 1))) {
+                return true;
+            }
+            if (Value(literals[i]) == 0) {
+                literals[kept++] = literals[i];
+            }
+        }
+        literals.resize(kept);
+        if (literals.empty()) {
+            return ok_ = false;
+        }
+        if (literals.size() == 1) {
+            Assign(literals[0], NONE);
+            return ok_ = Propagate() == NONE;
+        }
+        Attach(Store(literals, false, 0));
+        return true;
+    }
+
+    // SAT - Model() holds the assignment, UNKNOWN - conflict_limit conflicts
+    // passed; clauses can be added after and Solve called again
+    SatResult Solve(uint64_t conflict_limit = UINT64_MAX) {
+        using namespace SatDetail;
+        if (!ok_) {
+            return SatResult::UNSAT;
+        }
+        const uint64_t conflict_end = conflict_limit == UINT64_MAX ? UINT64_MAX : stats_.conflicts + conflict_limit;
+        std::vector<uint32_t> learnt;
+        while (true) {
+            const uint64_t restart_end = stats_.conflicts + RESTART_UNIT * Luby(stats_.restarts);
+            while (true) {
+                const uint32_t conflict = Propagate();
+                if (conflict != NONE) {
+                    ++stats_.conflicts;
+                    if (Level() == 0) {
+                        ok_ = false;
+                        return SatResult::UNSAT;
+                    }
+                    const uint32_t back_level = Analyze(conflict, learnt);
+                    const uint32_t lbd = Lbd(learnt);
+                    Backtrack(back_level);
+                    if (learnt.size() == 1) {
+                        Assign(learnt[0], NONE);
+                    } else {
+                        const uint32_t clause = Store(learnt, true, lbd);
+                        Attach(clause);
+                        ++learnt_count_;
+                        Assign(learnt[0], clause);
+                    }
+                    var_inc_ /= DECAY;
+                    continue;
+                }
+                if (stats_.conflicts >= conflict_end) {
+                    Backtrack(0);
+                    return SatResult::UNKNOWN;
+                }
+                if (stats_.conflicts >= restart_end || learnt_count_ >= next_reduction_) {
+                    break;
+                }
+                uint32_t variable = NONE;
+                while (!heap_.Empty()) {
+                    const uint32_t candidate = heap_.PopMax();
+                    if (Value(2 * candidate) == 0) {
+                        variable = candidate;
+                        break;
+                    }
+                }
+                if (variable == NONE) {
+                    for (uint32_t v = 0; v < VariableCount(); ++v) {
+                        model_[v] = Value(2 * v) > 0;
+                    }
+                    Backtrack(0);
+                    return SatResult::SAT;
+                }
+                ++stats_.decisions;
+                level_start_.push_back(trail_.size());
+                Assign(2 * variable + phase_[variable], NONE);
+            }
+            Backtrack(0);
+            ++stats_.restarts;
+            if (learnt_count_ >= next_reduction_) {
+                Reduce();
+            }
+        }
+    }
+
+    // value of the variable (1-based) in the last found assignment
+    bool Model(int variable) const {
+        return model_[variable - 1];
+    }
+
+    const SatStats& Stats() const {
+        return stats_;
+    }
+
+private:
+    int8_t Value(uint32_t literal) const {
+        return value_[literal];
+    }
+
+    uint32_t Level() const {
+        return level_start_.size();
+    }
+
+    uint32_t* Literals(uint32_t clause) {
+        return arena_.data() + clause + SatDetail::HEADER;
+    }
+
+    uint32_t Size(uint32_t clause) const {
+        return arena_[clause];
+    }
+
+    void Assign(uint32_t literal, uint32_t reason) {
+        value_[literal] = 1;
+        value_[literal ^ 1] = -1;
+        level_[literal / 2] = Level();
+        reason_[literal / 2] = reason;
+        trail_.push_back(literal);
+    }
+
+    void Backtrack(uint32_t level) {
+        if (Level() <= level) {
+            return;
+        }
+        for (size_t i = trail_.size(); i-- > level_start_[level];) {
+            const uint32_t literal = trail_[i];
+            value_[literal] = value_[literal ^ 1] = 0;
+            phase_[literal / 2] = literal & 1;
+            heap_.Insert(literal / 2);
+        }
+        trail_.resize(level_start_[level]);
+        level_start_.resize(level);
+        propagated_ = std::min<size_t>(propagated_, trail_.size());
+    }
+
+    uint32_t Store(const std::vector<uint32_t>& literals, bool learnt, uint32_t lbd) {
+        const uint32_t clause = arena_.size();
+        arena_.push_back(literals.size());
+        arena_.push_back((learnt ? SatDetail::LEARNT : 0) | std::min(lbd, SatDetail::LBD_MASK));
+        arena_.insert(arena_.end(), literals.begin(), literals.end());
+        return clause;
+    }
+
+    void Attach(uint32_t clause) {
+        const uint32_t* literals = Literals(clause);
+        watches_[literals[0]].push_back({clause, literals[1]});
+        watches_[literals[1]].push_back({clause, literals[0]});
+    }
+
+    // returns the conflicting clause or NONE
+    uint32_t Propagate() {
+        using namespace SatDetail;
+        while (propagated_ < trail_.size()) {
+            const uint32_t false_literal = trail_[propagated_++] ^ 1;
+            ++stats_.propagations;
+            std::vector<Watch>& watches = watches_[false_literal];
+            size_t i = 0;
+            size_t j = 0;
+            while (i < watches.size()) {
+                const Watch watch = watches[i++];
+                if (Value(watch.blocker) > 0) {
+                    watches[j++] = watch;
+                    continue;
+                }
+                uint32_t* literals = Literals(watch.clause);
+                if (literals[0] == false_literal) {
+                    std::swap(literals[0], literals[1]);
+                }
+                const uint32_t first = literals[0];
+                if (first != watch.blocker && Value(first) > 0) {
+                    watches[j++] = {watch.clause, first};
+                    continue;
+                }
+                const uint32_t size = Size(watch.clause);
+                bool moved = false;
+                for (uint32_t k = 2; k < size; ++k) {
+                    if (Value(literals[k]) >= 0) {
+                        std::swap(literals[1], literals[k]);
+                        watches_[literals[1]].push_back({watch.clause, first});
+                        moved = true;
+                        break;
+                    }
+                }
+                if (moved) {
+                    continue;
+                }
+                watches[j++] = {watch.clause, first};
+                if (Value(first) < 0) {
+                    while (i < watches.size()) {
+                        watches[j++] = watches[i++];
+                    }
+                    watches.resize(j);
+                    propagated_ = trail_.size();
+                    return watch.clause;
+                }
+                Assign(first, watch.clause);
+            }
+            watches.resize(j);
+        }
+        return NONE;
+    }
+
+    void Bump(uint32_t variable) {
+        if ((activity_[variable] += var_inc_) > 1e100) {
+            for (double& activity : activity_) {
+                activity *= 1e-100;
+            }
+            var_inc_ *= 1e-100;
+        }
+        heap_.Increased(variable);
+    }
+
+    // first UIP clause into learnt (the asserting literal first, a literal of
+    // the backtrack level second), returns the backtrack level
+    uint32_t Analyze(uint32_t conflict, std::vector<uint32_t>& learnt) {
+        using namespace SatDetail;
+        learnt.assign(1, NONE);
+        uint32_t pending = 0;
+        uint32_t literal = NONE;
+        size_t index = trail_.size();
+        uint32_t clause = conflict;
+        do {
+            const uint32_t* literals = Literals(clause);
+            const uint32_t size = Size(clause);
+            // the implied literal of a reason is its first one
+            for (uint32_t k = literal == NONE ? 0 : 1; k < size; ++k) {
+                const uint32_t variable = literals[k] / 2;
+                if (seen_[variable] || level_[variable] == 0) {
+                    continue;
+                }
+                seen_[variable] = 1;
+                Bump(variable);
+                if (level_[variable] == Level()) {
+                    ++pending;
+                } else {
+                    learnt.push_back(literals[k]);
+                }
+            }
+            while (!seen_[trail_[--index] / 2]) {
+            }
+            literal = trail_[index];
+            clause = reason_[literal / 2];
+            seen_[literal / 2] = 0;
+        } while (--pending > 0);
+        learnt[0] = literal ^ 1;
+
+        // a literal is redundant if all of its reason is in the clause
+        analyzed_.assign(learnt.begin() + 1, learnt.end());
+        size_t kept = 1;
+        for (size_t i = 1; i < learnt.size(); ++i) {
+            const uint32_t reason = reason_[learnt[i] / 2];
+            bool redundant = reason != NONE;
+            if (redundant) {
+                const uint32_t* literals = Literals(reason);
+                for (uint32_t k = 1; k < Size(reason); ++k) {
+                    const uint32_t variable = literals[k] / 2;
+                    if (!seen_[variable] && level_[variable] > 0) {
+                        redundant = false;
+                        break;
+                    }
+                }
+            }
+            if (!redundant) {
+                learnt[kept++] = learnt[i];
+            }
+        }
+        learnt.resize(kept);
+        for (const uint32_t analyzed : analyzed_) {
+            seen_[analyzed / 2] = 0;
+        }
+        stats_.learnt_literals += learnt.size();
+
+        uint32_t back_level = 0;
+        for (size_t i = 1; i < learnt.size(); ++i) {
+            if (level_[learnt[i] / 2] > back_level) {
+                back_level = level_[learnt[i] / 2];
+                std::swap(learnt[1], learnt[i]);
+            }
+        }
+        return back_level;
+    }
+
+    uint32_t Lbd(const std::vector<uint32_t>& learnt) {
+        ++stamp_;
+        level_stamp_.resize(Level() + 1, 0);
+        uint32_t lbd = 0;
+        for (const uint32_t literal : learnt) {
+            const uint32_t level = level_[literal / 2];
+            if (level_stamp_[level] != stamp_) {
+                level_stamp_[level] = stamp_;
+                ++lbd;
+            }
+        }
+        return lbd;
+    }
+
+    // at level 0
+    void Reduce() {
+        using namespace SatDetail;
+        ++stats_.reductions;
+        std::vector<uint32_t> learnts;
+        for (uint32_t clause = 0; clause < arena_.size(); clause += HEADER + Size(clause)) {
+            const uint32_t* literals = Literals(clause);
+            bool satisfied = false;
+            for (uint32_t k = 0; k < Size(clause) && !satisfied; ++k) {
+                satisfied = Value(literals[k]) > 0;
+            }
+            if (satisfied) {
+                arena_[clause + 1] |= DELETED;
+            } else if ((arena_[clause + 1] & LEARNT) && (arena_[clause + 1] & LBD_MASK) > 2) {
+                learnts.push_back(clause);
+            }
+        }
+        std::stable_sort(learnts.begin(), learnts.end(), [&](uint32_t lhs, uint32_t rhs) {
+            return (arena_[lhs + 1] & LBD_MASK) > (arena_[rhs + 1] & LBD_MASK);
+        });
+        for (size_t i = 0; i < learnts.size() / 2; ++i) {
+            arena_[learnts[i] + 1] |= DELETED;
+        }
+
+        for (std::vector<Watch>& watches : watches_) {
+            watches.clear();
+        }
+        uint32_t end = 0;
+        learnt_count_ = 0;
+        for (uint32_t clause = 0; clause < arena_.size();) {
+            const uint32_t length = HEADER + Size(clause);
+            if (!(arena_[clause + 1] & DELETED)) {
+                std::copy(arena_.begin() + clause, arena_.begin() + clause + length, arena_.begin() + end);
+                Attach(end);
+                learnt_count_ += (arena_[end + 1] & LEARNT) != 0;
+                end += length;
+            }
+            clause += length;
+        }
+        arena_.resize(end);
+        // the reasons of level 0 are never looked at
+        for (const uint32_t literal : trail_) {
+            reason_[literal / 2] = NONE;
+        }
+        next_reduction_ = learnt_count_ + FIRST_REDUCTION + REDUCTION_STEP * stats_.reductions;
+    }
+
+    bool ok_ = true;
+    std::vector<uint32_t> arena_;
+    std::vector<std::vector<SatDetail::Watch>> watches_;
+    std::vector<int8_t> value_;
+    std::vector<uint32_t> level_;
+    std::vector<uint32_t> reason_;
+    std::vector<uint32_t> trail_;
+    std::vector<uint32_t> level_start_;
+    size_t propagated_ = 0;
+
+    std::vector<double> activity_;
+    double var_inc_ = 1.0;
+    SatDetail::ActivityHeap heap_{activity_};
+    std::vector<uint8_t> phase_;
+
+    std::vector<uint8_t> seen_;
+    std::vector<uint32_t> analyzed_;
+    std::vector<uint32_t> level_stamp_;
+    uint32_t stamp_ = 0;
+
+    uint64_t learnt_count_ = 0;
+    uint64_t next_reduction_ = SatDetail::FIRST_REDUCTION;
+    std::vector<bool> model_;
+    SatStats stats_;
+};
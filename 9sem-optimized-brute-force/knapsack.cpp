@@ -1,9 +1,12 @@
 #include <algorithm>
 #include <cstdint>
+#include <execution>
 #include <iterator>
-#include <random>
+#include <memory_resource>
 #include <vector>
 #include "profile.h"
+#include "scan.h"
+#include "workload.h"
 
 using namespace std;
 
@@ -105,7 +108,7 @@ namespace SimpleBound {
 
 namespace KolesarNoEstimation {
 
-    int Try(const vector<Item>& items, int pivot_index, int max_weight, int current_cost, int rest_cost, int best_cost, vector<bool>& is_used) {
+    int Try(const vector<Item>& items, int pivot_index, int max_weight, int current_cost, int rest_cost, int best_cost, pmr::vector<bool>& is_used) {
         if (max_weight < 0) {
             return NO_SOLUTION_COST;
         }
@@ -135,14 +138,15 @@ namespace KolesarNoEstimation {
         return local_best_cost;
     }
 
-    int Solve(vector<Item> items, int max_weight) {
+    // is_used is allocated in resource
+    int Solve(vector<Item> items, int max_weight, pmr::memory_resource* resource = pmr::get_default_resource()) {
         const int item_count = items.size();
         sort(items.begin(), items.end(),
              [](Item lhs, Item rhs) {
                 return static_cast<uint64_t>(lhs.cost) * rhs.weight
                     > static_cast<uint64_t>(rhs.cost) * lhs.weight;
              });
-        vector<bool> is_used(item_count, false);
+        pmr::vector<bool> is_used(item_count, false, resource);
         const int total_cost = transform_reduce(items.begin(), items.end(), 0, plus<>{}, [](Item item) { return item.cost; });
         return Try(items, 0, max_weight, 0, total_cost, NO_SOLUTION_COST, is_used);
     }
@@ -167,7 +171,7 @@ namespace KolesarDFS {
         return max_rest_cost;
     }
 
-    int Try(const vector<Item>& items, int pivot_index, int max_weight, int current_cost, int best_cost, vector<bool>& is_used) {
+    int Try(const vector<Item>& items, int pivot_index, int max_weight, int current_cost, int best_cost, pmr::vector<bool>& is_used) {
         if (max_weight < 0) {
             return NO_SOLUTION_COST;
         }
@@ -196,10 +200,11 @@ namespace KolesarDFS {
         return local_best_cost;
     }
 
-    int Solve(vector<Item> items, int max_weight) {
+    // is_used is allocated in resource
+    int Solve(vector<Item> items, int max_weight, pmr::memory_resource* resource = pmr::get_default_resource()) {
         const int item_count = items.size();
         sort(items.begin(), items.end(), [](Item lhs, Item rhs) { return static_cast<uint64_t>(lhs.cost) * rhs.weight > static_cast<uint64_t>(rhs.cost) * lhs.weight; });
-        vector<bool> is_used(item_count, false);
+        pmr::vector<bool> is_used(item_count, false, resource);
         return Try(items, 0, max_weight, 0, NO_SOLUTION_COST, is_used);
     }
 
@@ -234,9 +239,10 @@ namespace MeetInTheMiddle {
         vector<Subset> subsets;
         SupportTry(items, 0, max_weight, {0, 0}, subsets);
         sort(subsets.begin(), subsets.end(), [](Subset lhs, Subset rhs) { return lhs.weight < rhs.weight; });
-        partial_sum(
+        // running max of cost, associative so can be scanned in parallel
+        InclusiveScan(
+            execution::par,
             subsets.begin(), subsets.end(),
-            subsets.begin(),
             [](Subset lhs, Subset rhs) {
                 return Subset{max(lhs.cost, rhs.cost), rhs.weight};
             }
@@ -325,9 +331,10 @@ namespace MeetInTheMiddleOptimized {
         vector<Subset> subsets;
         SupportTry(items, 0, max_weight, {0, 0}, subsets);
         sort(subsets.begin(), subsets.end(), [](Subset lhs, Subset rhs) { return lhs.weight < rhs.weight; });
-        partial_sum(
+        // running max of cost, associative so can be scanned in parallel
+        InclusiveScan(
+            execution::par,
             subsets.begin(), subsets.end(),
-            subsets.begin(),
             [](Subset lhs, Subset rhs) {
                 return Subset{max(lhs.cost, rhs.cost), rhs.weight};
             }
@@ -409,7 +416,7 @@ namespace MeetInTheMiddleOptimized {
         const vector<Subset> support_subsets =
             GenerateSupportSubsets(
                 support_items,
-                max(0, max_weight - base_min_weight);
+                max(0, max_weight - base_min_weight));
 
         LOG_DURATION("--- base bt")
         return BaseTry(base_items, support_subsets, 0, max_weight, 0, NO_SOLUTION_COST);
@@ -418,19 +425,16 @@ namespace MeetInTheMiddleOptimized {
 }
 
 
-Item GenerateItem(mt19937& generator, int max_cost, int max_weight) {
-    return {
-        uniform_int_distribution(1, max_cost)(generator),
-        uniform_int_distribution(1, max_weight)(generator)
-    };
-}
-
-vector<Item> GenerateItems(mt19937& generator, int item_count, int max_cost, int max_weight) {
-    vector<Item> items;
-    items.reserve(item_count);
-    for (int i = 0; i < item_count; ++i) {
-        items.push_back(GenerateItem(generator, max_cost, max_weight));
-    }
+// the i-th item depends only on (seed, i), so items are generated in parallel
+vector<Item> GenerateItems(uint64_t seed, int item_count, int max_cost, int max_weight) {
+    vector<Item> items(item_count);
+    ParallelFor(item_count, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            PhiloxRng rng(seed, i);
+            items[i].cost = rng.UniformInt(1, max_cost);
+            items[i].weight = rng.UniformInt(1, max_weight);
+        }
+    });
     return items;
 }
 
@@ -439,7 +443,7 @@ template<typename Solver>
 void Test(string_view mark, Solver solver, const vector<Item>& items, int max_weight) {
     int result;
     {
-        LOG_DURATION(mark);
+        PERF_SCOPE(string(mark));
         result = solver(items, max_weight);
     }
     if (result == NO_SOLUTION_COST) {
@@ -449,12 +453,11 @@ void Test(string_view mark, Solver solver, const vector<Item>& items, int max_we
     }
 }
 
-#define TEST(ns) Test(#ns, ns::Solve, items, max_weight)
+// a lambda, not ns::Solve itself: some Solve have a default memory_resource argument
+#define TEST(ns) Test(#ns, [](const vector<Item>& items, int max_weight) { return ns::Solve(items, max_weight); }, items, max_weight)
 
 
 int main() {
-    mt19937 generator;
-
     const vector<Item> items_small = {
         {40, 60},
         {60, 50}, // +
@@ -478,13 +481,13 @@ int main() {
     (void) nomim;
     */
 
-    const vector<Item> items_l = GenerateItems(generator, 25, 10'000, 1'000'000);
+    const vector<Item> items_l = GenerateItems(1, 25, 10'000, 1'000'000);
     const TestCase l_normal = {items_l, 10'000'000};
     const TestCase l_all = {items_l, 1'000'000'000};
     (void) l_normal;
     (void) l_all;
 
-    const vector<Item> items_xl = GenerateItems(generator, 39, 10'000, 1'000'000);
+    const vector<Item> items_xl = GenerateItems(2, 39, 10'000, 1'000'000);
     const TestCase xl_vmany = {items_xl, 15'000'000};
     const TestCase xl_many = {items_xl, 10'000'000};
     const TestCase xl_less = {items_xl, 7'000'000};
@@ -492,7 +495,7 @@ int main() {
     (void) xl_many;
     (void) xl_less;
 
-    const vector<Item> items_xxl = GenerateItems(generator, 1000, 10'000, 1'000'000);
+    const vector<Item> items_xxl = GenerateItems(3, 1000, 10'000, 1'000'000);
     const TestCase xxl_normal = {items_xxl, 100'000'000};
     (void) xxl_normal;
 
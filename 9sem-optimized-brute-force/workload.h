@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Fast generation of synthetic test data.
+//
+// mt19937 is one sequential stream: the i-th query depends on all previous
+// ones, so it can't be generated in parallel. Philox is counter-based:
+// the random numbers of the i-th element are a function of (seed, i) only,
+// so any element can be generated by any thread and the result doesn't
+// depend on the number of threads.
+//
+// Strings are not stored one by one in std::string (20M small allocations),
+// but in one StringArena: all bytes in one buffer plus string_view's into it.
+
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+class PhiloxRng {
+public:
+    using result_type = uint32_t;
+
+    // stream number `stream` of the generator `seed`
+    PhiloxRng(uint64_t seed, uint64_t stream)
+        : key_{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}
+        , counter_{static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32), 0, 0}
+    {
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return UINT32_MAX;
+    }
+
+    result_type operator()() {
+        if (position_ == 4) {
+            Generate();
+            position_ = 0;
+        }
+        return block_[position_++];
+    }
+
+    // uniform in [from, to], multiply-shift without rejection:
+    // the bias is ~(to - from) / 2^32, nothing for test data
+    int UniformInt(int from, int to) {
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(to) - from) + 1;
+        return static_cast<int>(from + static_cast<int64_t>((range * (*this)()) >> 32));
+    }
+
+private:
+    static constexpr uint32_t M0 = 0xD2511F53;
+    static constexpr uint32_t M1 = 0xCD9E8D57;
+    static constexpr uint32_t W0 = 0x9E3779B9;
+    static constexpr uint32_t W1 = 0xBB67AE85;
+
+    void Generate() {
+        uint32_t x0 = counter_[0], x1 = counter_[1], x2 = counter_[2], x3 = counter_[3];
+        uint32_t k0 = key_[0], k1 = key_[1];
+        for (int round = 0; round < 10; ++round) {
+            const uint64_t p0 = static_cast<uint64_t>(M0) * x0;
+            const uint64_t p1 = static_cast<uint64_t>(M1) * x2;
+            x0 = static_cast<uint32_t>(p1 >> 32) ^ x1 ^ k0;
+            x1 = static_cast<uint32_t>(p1);
+            x2 = static_cast<uint32_t>(p0 >> 32) ^ x3 ^ k1;
+            x3 = static_cast<uint32_t>(p0);
+            k0 += W0;
+            k1 += W1;
+        }
+        block_[0] = x0;
+        block_[1] = x1;
+        block_[2] = x2;
+        block_[3] = x3;
+        // next block of the same stream
+        if (++counter_[2] == 0) {
+            ++counter_[3];
+        }
+    }
+
+    uint32_t key_[2];
+    uint32_t counter_[4];
+    uint32_t block_[4] = {0, 0, 0, 0};
+    int position_ = 4;
+};
+
+
+// one block per thread, but not less than 1024 elements in a block
+inline size_t ParallelBlockCount(size_t count) {
+    return std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count / 1024));
+}
+
+
+// Splits [0, count) into one range per thread and calls fn(block, begin, end)
+// for every range in parallel.
+template<typename Fn>
+void ParallelFor(size_t count, Fn fn) {
+    const size_t block_count = ParallelBlockCount(count);
+    std::vector<std::future<void>> blocks;
+    for (size_t i = 1; i < block_count; ++i) {
+        blocks.push_back(std::async(std::launch::async, fn, i, count * i / block_count, count * (i + 1) / block_count));
+    }
+    fn(0, 0, count / block_count);
+    for (auto& block : blocks) {
+        block.get();
+    }
+}
+
+class StringArena {
+public:
+    StringArena() = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    // moving a vector keeps its buffer, so the views stay valid
+    StringArena(StringArena&&) = default;
+    StringArena& operator=(StringArena&&) = default;
+
+    // generate(rng, buffer) appends the i-th string to the std::string buffer,
+    // rng is the i-th stream of seed.
+    // Every thread generates its range into its own buffer, then the buffers
+    // are copied to the arena: so every string is generated only once.
+    template<typename StringGenerator>
+    static StringArena Generate(size_t count, uint64_t seed, StringGenerator generate) {
+        const size_t block_count = ParallelBlockCount(count);
+        std::vector<std::string> block_bytes(block_count);
+        std::vector<std::vector<uint32_t>> block_ends(block_count);
+        ParallelFor(count, [&](size_t block, size_t begin, size_t end) {
+            std::string& bytes = block_bytes[block];
+            std::vector<uint32_t>& ends = block_ends[block];
+            ends.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                PhiloxRng rng(seed, i);
+                generate(rng, bytes);
+                ends.push_back(bytes.size());
+            }
+        });
+
+        std::vector<size_t> block_offsets(block_count + 1, 0);
+        for (size_t block = 0; block < block_count; ++block) {
+            block_offsets[block + 1] = block_offsets[block] + block_bytes[block].size();
+        }
+
+        StringArena arena;
+        arena.bytes_.resize(block_offsets.back());
+        arena.views_.resize(count);
+        ParallelFor(count, [&](size_t block, size_t begin, size_t) {
+            char* out = arena.bytes_.data() + block_offsets[block];
+            std::copy(block_bytes[block].begin(), block_bytes[block].end(), out);
+            std::string().swap(block_bytes[block]);
+            uint32_t previous_end = 0;
+            for (const uint32_t end : block_ends[block]) {
+                arena.views_[begin++] = std::string_view(out + previous_end, end - previous_end);
+                previous_end = end;
+            }
+        });
+        return arena;
+    }
+
+    size_t size() const {
+        return views_.size();
+    }
+
+    std::string_view operator[](size_t i) const {
+        return views_[i];
+    }
+
+    auto begin() const {
+        return views_.begin();
+    }
+
+    auto end() const {
+        return views_.end();
+    }
+
+private:
+    std::vector<char> bytes_;
+    std::vector<std::string_view> views_;
+};